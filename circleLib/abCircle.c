@@ -1,15 +1,18 @@
 #include "shape.h"
 #include "_abCircle.h"
+#include "_shapekind.h"
 
 // true if pixel is in circle centered at centerPos
 int abCircleCheck(const AbCircle *circle, const Vec2 *centerPos, const Vec2 *pixel)
 {
-  u_char radius = circle->radius;
-  int axis;
-  Vec2 relPos;
-  vec2Sub(&relPos, pixel, centerPos); /* vector from center to pixel */
-  vec2Abs(&relPos);		      /* project to first quadrant */
-  return (relPos.axes[0] <= radius && circle->chords[relPos.axes[0]] >= relPos.axes[1]);
+  return kernelCircleCheck(circle, centerPos, pixel);
+}
+
+// the row's chord: columns whose chords reach the row's distance from center
+int
+abCircleGetSpans(const AbCircle *circle, const Vec2 *centerPos, int row, Span spans[])
+{
+  return kernelCircleSpans(circle, centerPos, row, spans);
 }
   
 void
@@ -3,7 +3,7 @@
 #include <lcddraw.h>
 #include "abCircle.h"
 
-AbRect rect10 = {abRectGetBounds, abRectCheck, {10,10}};; /**< 10x10 rectangle */
+AbRect rect10 = {abRectGetBounds, abRectCheck, abRectGetSpans, ABSHAPE_RECT, {10,10}};; /**< 10x10 rectangle */
 
 u_int bgColor = COLOR_BLUE;
 
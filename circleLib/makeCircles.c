@@ -80,7 +80,7 @@ int main()
       fprintf(fp, "#include \"abCircle.h\"\n\n");
       fprintf(fp, "#include \"chordVec.h\"\n\n");
       fprintf(fp, "const AbCircle circle%d = {" , radius);
-      fprintf(fp, "  abCircleGetBounds, abCircleCheck, chordVec%d, %d", radius, radius);
+      fprintf(fp, "  abCircleGetBounds, abCircleCheck, abCircleGetSpans, ABSHAPE_CIRCLE, chordVec%d, %d", radius, radius);
       fprintf(fp, "};\n");
       fclose(fp);
     }
@@ -0,0 +1,170 @@
+/** \file renderbench.c
+ *  \brief Times layerDraw with the three ways of reaching a shape
+ *
+ *  The same scene is composed three times into a driver that
+ *  discards pixels, so only rendering is timed:
+ *
+ *   - kinds: built-in kinds, drawn by shapeLib's inline kernels
+ *   - spans: the same shapes as ABSHAPE_CUSTOM, so their check and
+ *     getSpans functions are called through pointers
+ *   - check: ABSHAPE_CUSTOM without getSpans: check() per pixel
+ *
+ *  On the MSP430 Timer A0 counts SMCLK (CPU clock / 8) and results
+ *  are CPU cycles per frame.  Host builds report nanoseconds per
+ *  frame.  The scene and the results are then drawn on the lcd.
+ */
+#include <libTimer.h>
+#include <lcdutils.h>
+#include <lcddraw.h>
+#include <lcddriver.h>
+#include "abCircle.h"
+#include "chordVec.h"
+
+#ifdef __MSP430__
+#include <msp430.h>
+#define BENCH_FRAMES 1
+#define BENCH_UNIT "cyc"
+#else
+#include <stdio.h>
+#include <time.h>
+#define BENCH_FRAMES 200
+#define BENCH_UNIT "ns"
+#endif
+
+u_int bgColor = COLOR_BLACK;
+
+AbRect paddle = {abRectGetBounds, abRectCheck, abRectGetSpans, ABSHAPE_RECT, {20,3}};
+AbRect ball = {abRectGetBounds, abRectCheck, abRectGetSpans, ABSHAPE_RECT, {2,2}};
+AbRectOutline field = {abRectOutlineGetBounds, abRectOutlineCheck, abRectOutlineGetSpans,
+		       ABSHAPE_RECT_OUTLINE, {screenWidth/2 - 1, screenHeight/2 - 5}};
+AbRArrow arrow = {abRArrowGetBounds, abRArrowCheck, abRArrowGetSpans, ABSHAPE_RARROW, 30};
+AbCircle circle = {abCircleGetBounds, abCircleCheck, abCircleGetSpans, ABSHAPE_CIRCLE,
+		   chordVec30, 30};
+
+Layer layerBall = {(AbShape *)&ball, {90, 100}, {0,0}, {0,0}, COLOR_WHITE, 0};
+Layer layerCpu = {(AbShape *)&paddle, {64, 14}, {0,0}, {0,0}, COLOR_ORANGE, &layerBall};
+Layer layerPlayer = {(AbShape *)&paddle, {64, 146}, {0,0}, {0,0}, COLOR_PURPLE, &layerCpu};
+Layer layerArrow = {(AbShape *)&arrow, {100, 50}, {0,0}, {0,0}, COLOR_GREEN, &layerPlayer};
+Layer layerCircle = {(AbShape *)&circle, {50, 90}, {0,0}, {0,0}, COLOR_RED, &layerArrow};
+Layer layerField = {(AbShape *)&field, {screenWidth/2, screenHeight/2},
+		    {0,0}, {0,0}, COLOR_GRAY, &layerCircle};
+
+static void nullWindow(u_int colStart, u_int rowStart, u_int colEnd, u_int rowEnd) {}
+static void nullStream(u_int colorBGR) {}
+static void nullRun(u_int colorBGR, u_int count) {}
+static void nullFlush() {}
+
+static const LcdDriver nullDriver = {
+  nullWindow, nullStream, nullRun, nullFlush,
+  screenWidth, screenHeight, LCD_CAP_CHEAPWIN
+};
+
+#ifdef __MSP430__
+static volatile u_int overflows;
+
+void
+__interrupt_vec(TIMER0_A1_VECTOR) bench_overflow()
+{
+  if (TA0IV == TA0IV_TAIFG)
+    overflows++;
+}
+
+static void
+benchStart()
+{
+  overflows = 0;
+  TA0CTL = TASSEL_2 | MC_2 | TACLR | TAIE; /* continuous, SMCLK */
+}
+
+static unsigned long
+benchStop()
+{
+  TA0CTL &= ~MC_3;
+  if (TA0CTL & TAIFG) {		/* overflowed while stopping */
+    TA0CTL &= ~TAIFG;
+    overflows++;
+  }
+  return (((unsigned long)overflows << 16) | TA0R) * 8;
+}
+#else
+static clock_t benchClock;
+
+static void
+benchStart()
+{
+  benchClock = clock();
+}
+
+static unsigned long
+benchStop()
+{
+  return (unsigned long)((double)(clock() - benchClock) * 1e9 / CLOCKS_PER_SEC);
+}
+#endif
+
+/** Render the scene BENCH_FRAMES times with every shape of the given
+ *  kind and getSpans; returns the time per frame */
+static unsigned long
+benchFrames(u_char custom, u_char spans)
+{
+  int i;
+  paddle.kind = ball.kind = custom ? ABSHAPE_CUSTOM : ABSHAPE_RECT;
+  field.kind = custom ? ABSHAPE_CUSTOM : ABSHAPE_RECT_OUTLINE;
+  arrow.kind = custom ? ABSHAPE_CUSTOM : ABSHAPE_RARROW;
+  circle.kind = custom ? ABSHAPE_CUSTOM : ABSHAPE_CIRCLE;
+  paddle.getSpans = ball.getSpans = spans ? abRectGetSpans : 0;
+  field.getSpans = spans ? abRectOutlineGetSpans : 0;
+  arrow.getSpans = spans ? abRArrowGetSpans : 0;
+  circle.getSpans = spans ? abCircleGetSpans : 0;
+
+  lcdDriver = &nullDriver;
+  benchStart();
+  for (i = 0; i < BENCH_FRAMES; i++)
+    layerDraw(&layerField);
+  return benchStop() / BENCH_FRAMES;
+}
+
+/** Draw "label value" at row */
+static void
+report(u_char row, const char *label, unsigned long value)
+{
+  char line[22], digits[11];
+  u_char i = 0, n = 0;
+  do {
+    digits[n++] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  while (*label)
+    line[i++] = *label++;
+  line[i++] = ' ';
+  while (n)
+    line[i++] = digits[--n];
+  line[i++] = ' ';
+  for (label = BENCH_UNIT; *label; )
+    line[i++] = *label++;
+  line[i] = 0;
+  drawString5x7(4, row, line, COLOR_YELLOW, COLOR_BLACK);
+#ifndef __MSP430__
+  printf("%s\n", line);
+#endif
+}
+
+int
+main()
+{
+  unsigned long kinds, spans, check;
+
+  configureClocks();
+  lcd_init();
+  or_sr(0x8);			/**< GIE: counts timer overflows */
+
+  check = benchFrames(1, 0);
+  spans = benchFrames(1, 1);
+  kinds = benchFrames(0, 1);
+
+  lcdDriver = &lcdSt7735Driver;
+  layerDraw(&layerField);
+  report(20, "kinds", kinds);
+  report(30, "spans", spans);
+  report(40, "check", check);
+}
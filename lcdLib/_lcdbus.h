@@ -0,0 +1,75 @@
+/** \file _lcdbus.h
+ *  \brief Byte-level interface between lcdutils and the LCD controller.
+ *
+ *  Implemented by lcdspi.c (USCI_B0 SPI on the msp430) and by
+ *  lcdsim.c (an emulated ST7735 for host builds).
+ */
+
+#ifndef _lcdbus_included
+#define _lcdbus_included
+
+#include "lcdutils.h"
+#include "lcdcapture.h"
+
+/** LCD driver IC specific defines */
+#define SWRESET							0x01
+#define	SLEEPOUT						0x11
+#define NORON							0x13
+#define DISPON							0x29
+#define CASETP							0x2A
+#define PASETP							0x2B
+#define RAMWRP							0x2C
+#define VSCRDEF							0x33
+#define	MADCTL							0x36
+#define VSCRSADD						0x37
+#define	COLMOD							0x3A
+#define GMCTRP1							0xE0
+#define GMCTRN1							0xE1
+
+/** Set up the bus and control pins */
+void _setUpBus();
+
+/** Write command to LCD.  Pending data is flushed first. */
+void _writeCommand(u_char command);
+
+/** Write one data byte to LCD */
+void _writeData(u_char data);
+
+/** Write the byte pair (hi, lo) count times */
+void _writeDataRun(u_char hi, u_char lo, u_int count);
+
+/** Write the byte triple (b0, b1, b2) count times */
+void _writeDataRun3(u_char b0, u_char b1, u_char b2, u_int count);
+
+/** Wait until all queued bytes have been sent */
+void _flush();
+
+/** Long delay */
+void _delay(u_char x10ms);
+
+/** Start a delay and return; done is called (from an interrupt
+ *  handler) when it has elapsed.  done may start another delay.
+ */
+void _startDelay(u_char x10ms, void (*done)());
+
+/** Sleep until an interrupt handler sets *flag */
+void _sleepUntil(volatile u_char *flag);
+
+/** Capture hooks (lcdcapture.c): transports report each command,
+ *  data byte and run here while lcdCaptureOn is set
+ */
+void _captureCommand(u_char command);
+void _captureData(u_char data);
+void _captureRun(u_char hi, u_char lo, u_int count);
+void _captureRun3(u_char b0, u_char b1, u_char b2, u_int count);
+
+/** Start the capture timestamp clock (one tick per byte time on the
+ *  bus).  Returns 0, leaving the clock alone, while a delay
+ *  (_startDelay) is using it.
+ */
+int _captureClockStart();
+
+/** Current capture timestamp */
+u_int _captureClock();
+
+#endif // included
@@ -0,0 +1,34 @@
+/** \file _lcdfont.h
+ *  \brief Font descriptors shared by the string renderers (private)
+ *
+ *  Each font's tables are only referenced from the file that draws
+ *  it (lcddraw.c for 5x7, lcdfonts.c for 8x12 and 11x16), so a
+ *  program links in only the fonts it draws with.
+ */
+
+#ifndef _lcdfont_included
+#define _lcdfont_included
+
+#include "lcdutils.h"
+
+/** Font description used by the string renderers
+ *
+ *  rowBits returns one pixel row of a glyph with the leftmost pixel
+ *  in bit (width - 1).  gap is the number of background columns
+ *  between glyphs.
+ */
+typedef struct {
+  u_char width, height, gap;
+  u_int (*rowBits)(char c, u_char row);
+} Font;
+
+/** Draw string with background through a single window
+ *
+ *  The window covers the whole string including the gaps between
+ *  glyphs; it is streamed row by row as fg/bg runs.  Strings that
+ *  extend past the screen are clipped.
+ */
+void _drawStringFont(int col, int row, const char *string, const Font *font,
+		     u_int fgColorBGR, u_int bgColorBGR);
+
+#endif // included
@@ -0,0 +1,144 @@
+/** \file lcdcapture.c
+ *  \brief Recording of the LCD command stream (see lcdcapture.h)
+ *
+ *  The transports (lcdspi.c, lcdsim.c) call the _capture hooks of
+ *  _lcdbus.h while lcdCaptureOn is set.
+ */
+#include "lcdcapture.h"
+#include "_lcdbus.h"
+
+u_char lcdCaptureOn, lcdCaptureOverflow;
+
+static u_char *buf;
+static u_int size, used;
+static u_char timestamps;
+static u_int lastRecord;	/**< offset of the last record */
+
+/** Reserve n bytes for a new record; on overflow capture stops (private) */
+static u_char *
+reserve(u_char n)
+{
+  if (used + n > size) {
+    lcdCaptureOn = 0;
+    lcdCaptureOverflow = 1;
+    return 0;
+  }
+  lastRecord = used;
+  used += n;
+  return buf + lastRecord;
+}
+
+static void
+put16(u_char *p, u_int v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+void
+lcdcapture_start(u_char *b, u_int n, u_char flags)
+{
+  buf = b;
+  size = n;
+  used = lastRecord = 0;
+  timestamps = (flags & LCDCAPTURE_TIMESTAMPS) && _captureClockStart();
+  lcdCaptureOverflow = 0;
+  lcdCaptureOn = 1;
+  if ((b = reserve(4))) {
+    b[0] = 'L';
+    b[1] = 'T';
+    b[2] = 1;
+    b[3] = timestamps;
+  }
+}
+
+u_int
+lcdcapture_stop()
+{
+  lcdCaptureOn = 0;
+  return used;
+}
+
+void
+lcdcapture_frame()
+{
+  u_char *p;
+  if (!lcdCaptureOn)
+    return;
+  if ((p = reserve(1)))
+    p[0] = 'F';
+}
+
+void
+_captureCommand(u_char command)
+{
+  u_char *p;
+  if (!(p = reserve(timestamps ? 4 : 2)))
+    return;
+  p[0] = 'C';
+  p[1] = command;
+  if (timestamps)
+    put16(p + 2, _captureClock());
+}
+
+void
+_captureData(u_char data)
+{
+  u_char *p = buf + lastRecord;
+  if (p[0] == 'D' && p[1] < 255) {
+    if (used < size) {
+      buf[used++] = data;
+      p[1]++;
+    } else {
+      lcdCaptureOn = 0;
+      lcdCaptureOverflow = 1;
+    }
+    return;
+  }
+  if (!(p = reserve(3)))
+    return;
+  p[0] = 'D';
+  p[1] = 1;
+  p[2] = data;
+}
+
+/** Runs of one pixel are stored as data; a run that repeats the
+ *  previous record's pattern extends it
+ */
+void
+_captureRun(u_char hi, u_char lo, u_int count)
+{
+  u_char *p;
+  if (count == 1) {
+    _captureData(hi);
+    _captureData(lo);
+    return;
+  }
+  p = buf + lastRecord;
+  if (p[0] == 'R' && p[1] == hi && p[2] == lo) {
+    u_int total = p[3] | (p[4] << 8);
+    if (count <= 0xffff - total) {
+      put16(p + 3, total + count);
+      return;
+    }
+  }
+  if (!(p = reserve(5)))
+    return;
+  p[0] = 'R';
+  p[1] = hi;
+  p[2] = lo;
+  put16(p + 3, count);
+}
+
+void
+_captureRun3(u_char b0, u_char b1, u_char b2, u_int count)
+{
+  u_char *p;
+  if (!(p = reserve(6)))
+    return;
+  p[0] = 'T';
+  p[1] = b0;
+  p[2] = b1;
+  p[3] = b2;
+  put16(p + 4, count);
+}
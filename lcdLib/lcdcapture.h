@@ -0,0 +1,56 @@
+/** \file lcdcapture.h
+ *  \brief Recording of the LCD command stream
+ *
+ *  While capture is on, every command and data byte sent to the
+ *  controller is appended to a caller-supplied buffer as compact
+ *  records.  On the msp430 the buffer can be read out with a debugger
+ *  (e.g. mspdebug's "save_raw"); host builds write it to the file
+ *  named by LCDSIM_TRACE.  lcdtrace (a host program) replays a
+ *  capture through the emulator and reports where the bytes went.
+ *
+ *  Record format (all multi-byte values little-endian):
+ *   - "LT" 1 flags		header; flags bit 0: commands are timestamped
+ *   - 'C' command [time16]	a command, with the clock value if timestamped
+ *   - 'D' n byte*n		n (1-255) data bytes
+ *   - 'R' hi lo count16	the pair (hi, lo) count times
+ *   - 'T' b0 b1 b2 count16	the triple (b0, b1, b2) count times
+ *   - 'F'			end of a frame (lcdcapture_frame)
+ *
+ *  Timestamps count Timer1_A at SMCLK/8, so a tick is the time one
+ *  byte takes on the bus in any clock profile: 4 us at CLOCK_SLOW
+ *  (wrapping every 262 ms), 1 us at CLOCK_FAST and 0.5 us at
+ *  CLOCK_MAX (wrapping every 33 ms).
+ */
+
+#ifndef lcdcapture_included
+#define lcdcapture_included
+
+#include "lcdutils.h"
+
+#define LCDCAPTURE_TIMESTAMPS 1	/**< flags for lcdcapture_start */
+
+/** Start capturing into buf (overwriting it)
+ *
+ *  Timestamps use Timer1_A, which must not be needed for anything
+ *  else (e.g. lcd_initAsync) meanwhile.  While an lcd delay is
+ *  pending the capture starts without timestamps (header flags 0).
+ *
+ *  \param buf Buffer for records
+ *  \param size Size of buf in bytes
+ *  \param flags LCDCAPTURE_TIMESTAMPS or 0
+ */
+void lcdcapture_start(u_char *buf, u_int size, u_char flags);
+
+/** Stop capturing.  Returns the number of bytes of buf used. */
+u_int lcdcapture_stop();
+
+/** Mark the end of a frame (drv_frameDone calls this) */
+void lcdcapture_frame();
+
+/** Nonzero while capturing */
+extern u_char lcdCaptureOn;
+
+/** Set if records were dropped because the buffer was full */
+extern u_char lcdCaptureOverflow;
+
+#endif // included
@@ -3,6 +3,7 @@
  */
 #include "lcdutils.h"
 #include "lcddraw.h"
+#include "_lcdfont.h"
 
 
 /** Draw single pixel at x,row 
@@ -30,11 +31,46 @@ void fillRectangle(u_char colMin, u_char rowMin, u_char width, u_char height,
 {
   u_char colLimit = colMin + width, rowLimit = rowMin + height;
   lcd_setArea(colMin, rowMin, colLimit - 1, rowLimit - 1);
-  u_int total = width * height;
-  u_int c = 0;
-  while ((c++) < total) {
-    lcd_writeColor(colorBGR);
+  lcd_writeColorRun(colorBGR, width * height);
+}
+
+/** Clip the interval [*start, *start + *len) to [0, limit)
+ *  Returns 0 if nothing is left. (private)
+ */
+static int
+clipSpan(int *start, int *len, int limit)
+{
+  if (*start < 0) {
+    *len += *start;
+    *start = 0;
   }
+  if (*start + *len > limit)
+    *len = limit - *start;
+  return *len > 0;
+}
+
+/** Draw single pixel; pixels off the screen are ignored */
+void drawPixel16(int col, int row, u_int colorBGR)
+{
+  if (col < 0 || row < 0 || col >= screenWidth || row >= screenHeight)
+    return;
+  lcd_setArea16(col, row, col, row);
+  lcd_writeColor(colorBGR);
+}
+
+/** Fill the on-screen part of a rectangle */
+void fillRectangle16(int colMin, int rowMin, int width, int height,
+		     u_int colorBGR)
+{
+  int row;
+  if (!clipSpan(&colMin, &width, screenWidth) || !clipSpan(&rowMin, &height, screenHeight))
+    return;
+  lcd_setArea16(colMin, rowMin, colMin + width - 1, rowMin + height - 1);
+  if ((unsigned long)width * height <= 0xffff)
+    lcd_writeColorRun(colorBGR, width * height);
+  else				/* too many pixels for one run */
+    for (row = 0; row < height; row++)
+      lcd_writeColorRun(colorBGR, width);
 }
 
 /** Clear screen (fill with color)
@@ -43,9 +79,8 @@ void fillRectangle(u_char colMin, u_char rowMin, u_char width, u_char height,
  */
 void clearScreen(u_int colorBGR) 
 {
-  u_char w = screenWidth;
-  u_char h = screenHeight;
-  fillRectangle(0, 0, screenWidth, screenHeight, colorBGR);
+  lcd_setArea(0, 0, screenWidth - 1, screenHeight - 1);
+  lcd_writeColorRun(colorBGR, (u_int)screenWidth * screenHeight);
 }
 
 /** 5x7 font - this function draws background pixels
@@ -72,10 +107,71 @@ void drawChar5x7(u_char rcol, u_char rrow, char c,
   }
 }
 
+/** 5x7 glyphs are stored as 5 columns, bit 0 at the top */
+static u_int
+rowBits5x7(char c, u_char row)
+{
+  const u_char *glyph = font_5x7[c - 0x20];
+  u_char bit = 1 << row, i;
+  u_int bits = 0;
+  for (i = 0; i < 5; i++)
+    bits = (bits << 1) | ((glyph[i] & bit) != 0);
+  return bits;
+}
+
+static const Font font5x7 = {5, 8, 1, rowBits5x7};
+
+void
+_drawStringFont(int col, int row, const char *string, const Font *font,
+	       u_int fgColorBGR, u_int bgColorBGR)
+{
+  u_char len = 0, r, i;
+  int fullWidth, width, height, visCol, visRow, x;
+  const char *s;
+  LcdRun run = {bgColorBGR, 0};
+
+  for (s = string; *s; s++)
+    len++;
+  if (!len)
+    return;
+  width = fullWidth = len * (font->width + font->gap) - font->gap;
+  height = font->height;
+  visCol = col;
+  visRow = row;
+  if (!clipSpan(&visCol, &width, screenWidth) || !clipSpan(&visRow, &height, screenHeight))
+    return;
+  lcd_setArea16(visCol, visRow, visCol + width - 1, visRow + height - 1);
+  if (width == fullWidth) {	/* all columns visible */
+    for (r = visRow - row; r < visRow - row + height; r++) {
+      for (s = string; *s; s++) {
+	u_int bits = font->rowBits(*s, r);
+	for (i = font->width; i--; )
+	  lcd_runAdd(&run, (bits >> i) & 1 ? fgColorBGR : bgColorBGR);
+	if (s[1])
+	  for (i = 0; i < font->gap; i++)
+	    lcd_runAdd(&run, bgColorBGR);
+      }
+    }
+  } else {			/* skip pixels off the screen */
+    for (r = visRow - row; r < visRow - row + height; r++) {
+      for (x = col, s = string; *s && x < visCol + width; s++) {
+	u_int bits = font->rowBits(*s, r);
+	for (i = font->width; i--; x++)
+	  if (x >= visCol && x < visCol + width)
+	    lcd_runAdd(&run, (bits >> i) & 1 ? fgColorBGR : bgColorBGR);
+	if (s[1])
+	  for (i = 0; i < font->gap; i++, x++)
+	    if (x >= visCol && x < visCol + width)
+	      lcd_runAdd(&run, bgColorBGR);
+      }
+    }
+  }
+  lcd_runFlush(&run);
+}
+
 /** Draw string at col,row
- *  Type:
- *  FONT_SM - small (5x8,) FONT_MD - medium (8x12,) FONT_LG - large (11x16)
- *  FONT_SM_BKG, FONT_MD_BKG, FONT_LG_BKG - as above, but with background color
+ *  The string is streamed row by row through a single window that
+ *  also covers the 1-pixel gap between glyphs.
  *  Adapted from RobG's EduKit
  *
  *  \param col Column to start drawing string
@@ -84,17 +180,122 @@ void drawChar5x7(u_char rcol, u_char rrow, char c,
  *  \param fgColorBGR Foreground color in BGR
  *  \param bgColorBGR Background color in BGR
  */
-void drawString5x7(u_char col, u_char row, char *string,
+void drawString5x7(int col, int row, char *string,
+		u_int fgColorBGR, u_int bgColorBGR)
+{
+  _drawStringFont(col, row, string, &font5x7, fgColorBGR, bgColorBGR);
+}
+
+/** Find c's glyph in a packed font, 0 if absent (private) */
+static const u_char *
+packedGlyph(const PackedFont *font, char c)
+{
+  u_char i;
+  if (!font->chars) {
+    i = c - 0x20;
+    return i < font->count ? font->data + font->offsets[i] : 0;
+  }
+  for (i = 0; i < font->count; i++)
+    if (font->chars[i] == c)
+      return font->data + font->offsets[i];
+  return 0;
+}
+
+/** Stream one packed glyph into a cellWidth-wide window (private)
+ *
+ *  Rows and columns outside the glyph's crop box become background
+ *  runs; only pixels inside it are bit-tested.
+ */
+static void
+drawPackedGlyph(const u_char *glyph, u_char cellWidth, u_char height,
 		u_int fgColorBGR, u_int bgColorBGR)
 {
-  u_char cols = col;
-  while (*string) {
-    drawChar5x7(cols, row, *string++, fgColorBGR, bgColorBGR);
-    cols += 6;
+  LcdRun run = {bgColorBGR, 0};
+  u_char x0, y0, w, h, r, i, mask = 0x80;
+  const u_char *bits;
+
+  if (!glyph || glyph[0] == 0xff) {
+    lcd_writeColorRun(bgColorBGR, cellWidth * height);
+    return;
+  }
+  x0 = glyph[0] >> 4;
+  y0 = glyph[0] & 0xf;
+  w = (glyph[1] >> 4) + 1;
+  h = (glyph[1] & 0xf) + 1;
+  bits = glyph + 2;
+  lcd_runAddCount(&run, bgColorBGR, y0 * cellWidth + x0);
+  for (r = 0; r < h; r++) {
+    if (r)
+      lcd_runAddCount(&run, bgColorBGR, cellWidth - w);
+    for (i = 0; i < w; i++) {
+      lcd_runAdd(&run, (*bits & mask) ? fgColorBGR : bgColorBGR);
+      if (!(mask >>= 1)) {
+	mask = 0x80;
+	bits++;
+      }
+    }
+  }
+  lcd_runAddCount(&run, bgColorBGR,
+		  cellWidth - x0 - w + (height - y0 - h) * cellWidth);
+  lcd_runFlush(&run);
+}
+
+/** Draw string at col,row using a packed font
+ *  One window per glyph; each covers the gap that follows it.
+ */
+void drawStringPacked(u_char col, u_char row, char *string,
+		      const PackedFont *font, u_int fgColorBGR, u_int bgColorBGR)
+{
+  u_char cellWidth = font->width + font->gap;
+  for (; *string; string++, col += cellWidth) {
+    u_char w = string[1] ? cellWidth : font->width;
+    lcd_setArea(col, row, col + w - 1, row + font->height - 1);
+    drawPackedGlyph(packedGlyph(font, *string), w, font->height,
+		    fgColorBGR, bgColorBGR);
   }
 }
 
 
+void textFieldInit(TextField *field, u_char col, u_char row,
+		   u_int fgColorBGR, u_int bgColorBGR)
+{
+  field->col = col;
+  field->row = row;
+  field->fgColorBGR = fgColorBGR;
+  field->bgColorBGR = bgColorBGR;
+  field->len = 0;
+}
+
+void textFieldUpdate(TextField *field, const char *text)
+{
+  char changed[TEXTFIELD_MAX + 1];
+  u_char len = 0, i, start;
+
+  while (len < TEXTFIELD_MAX && text[len])
+    len++;
+  for (i = 0; i < len; ) {
+    if (i < field->len && field->shown[i] == text[i]) {
+      i++;
+      continue;
+    }
+    for (start = i; i < len && (i >= field->len || field->shown[i] != text[i]); i++) {
+      changed[i - start] = text[i];
+      field->shown[i] = text[i];
+    }
+    changed[i - start] = 0;
+    if (start && start >= field->len) /* gap before a new character */
+      fillRectangle(field->col + 6 * start - 1, field->row, 1, 8, field->bgColorBGR);
+    drawString5x7(field->col + 6 * start, field->row, changed,
+		  field->fgColorBGR, field->bgColorBGR);
+  }
+  if (len < field->len) {	/* erase characters that are gone */
+    u_char col = field->col + 6 * len - (len ? 1 : 0);
+    fillRectangle(col, field->row, field->col + 6 * field->len - 1 - col, 8,
+		  field->bgColorBGR);
+  }
+  field->len = len;
+}
+
 /** Draw rectangle outline
  *  
  *  \param colMin Column start
@@ -115,3 +316,341 @@ void drawRectOutline(u_char colMin, u_char rowMin, u_char width, u_char height,
   fillRectangle(colMin + width, rowMin, 1, height, colorBGR);
 }
 
+/** Fill the span between two points of a row or a column (private) */
+static void
+fillSpan(u_char col0, u_char row0, u_char col1, u_char row1, u_int colorBGR)
+{
+  if (col1 < col0) { u_char t = col0; col0 = col1; col1 = t; }
+  if (row1 < row0) { u_char t = row0; row0 = row1; row1 = t; }
+  fillRectangle(col0, row0, col1 - col0 + 1, row1 - row0 + 1, colorBGR);
+}
+
+/** Draw a line (Bresenham), one span per row or column */
+void drawLine(u_char col0, u_char row0, u_char col1, u_char row1,
+	      u_int colorBGR)
+{
+  int dCol = col1 > col0 ? col1 - col0 : col0 - col1;
+  int dRow = row1 > row0 ? row1 - row0 : row0 - row1;
+  signed char sCol = col1 > col0 ? 1 : -1, sRow = row1 > row0 ? 1 : -1;
+  u_char col = col0, row = row0;
+  
+  if (dCol >= dRow) {		/* shallow: horizontal spans */
+    u_char spanStart = col;
+    int err = dCol >> 1;
+    while (col != col1) {
+      err -= dRow;
+      if (err < 0) {		/* next pixel is on the next row */
+	fillSpan(spanStart, row, col, row, colorBGR);
+	err += dCol;
+	row += sRow;
+	spanStart = col + sCol;
+      }
+      col += sCol;
+    }
+    fillSpan(spanStart, row, col, row, colorBGR);
+  } else {			/* steep: vertical spans */
+    u_char spanStart = row;
+    int err = dRow >> 1;
+    while (row != row1) {
+      err -= dCol;
+      if (err < 0) {
+	fillSpan(col, spanStart, col, row, colorBGR);
+	err += dRow;
+	col += sCol;
+	spanStart = row + sRow;
+      }
+      row += sRow;
+    }
+    fillSpan(col, spanStart, col, row, colorBGR);
+  }
+}
+
+/** Build table chordVec[d] of circle 1/2 widths at distances d from center
+ *  Uses Bresenham's circle algorithm (as circleLib/makeCircles.c)
+ */
+void computeChordVec(u_char chordVec[], u_char radius) 
+{
+  int col = radius, row = 0;	/* first coordinate (radius, 0) */
+  int dColSquared = 2 * col - 1; /* change in col**2 for a unit decrease in col */
+  int dRowSquared = 1;		/* change in row**2 for a unit increase in row */
+  int radiusSqErr = 0;		/* (radius, 0) is on the circle  */
+  int colPrev = -1;		/* force first entry */
+  
+  while (col >= row) {		/* only sweep first octant */
+    chordVec[row] = col;
+    if (colPrev != col)		/* mirror into 2nd octant */
+      chordVec[col] = row;
+    colPrev = col;
+    row++;
+    radiusSqErr += dRowSquared;
+    dRowSquared += 2;
+    if ((2 * radiusSqErr) > dColSquared) {
+      col--;
+      radiusSqErr -= dColSquared;
+      dColSquared -= 2;
+    }
+  }
+}
+
+/** Fill rows [rowMin, rowMax] from col - halfLeft to col + halfRight,
+ *  clipped to the screen (private)
+ */
+static void
+fillRowsCentered(int col, int rowMin, int rowMax, int halfLeft, int halfRight,
+		 u_int colorBGR)
+{
+  int colMin = col - halfLeft, colMax = col + halfRight;
+  if (colMin < 0) colMin = 0;
+  if (colMax > screenWidth - 1) colMax = screenWidth - 1;
+  if (rowMin < 0) rowMin = 0;
+  if (rowMax > screenHeight - 1) rowMax = screenHeight - 1;
+  if (colMin > colMax || rowMin > rowMax)
+    return;
+  fillRectangle(colMin, rowMin, colMax - colMin + 1, rowMax - rowMin + 1,
+		colorBGR);
+}
+
+/** Fill a circle
+ *
+ *  Rows at distance d above and below the center are spans of
+ *  half-width chords[d]; runs of rows with the same width become one
+ *  rectangle.
+ */
+void fillCircle(u_char col, u_char row, u_char radius, const u_char *chords,
+		u_int colorBGR)
+{
+  u_char d = 0;
+  while (d <= radius) {
+    u_char dEnd = d, half = chords[d];
+    while (dEnd < radius && chords[dEnd + 1] == half)
+      dEnd++;
+    if (d == 0)			/* the band through the center */
+      fillRowsCentered(col, (int)row - dEnd, row + dEnd, half, half, colorBGR);
+    else {
+      fillRowsCentered(col, (int)row - dEnd, (int)row - d, half, half, colorBGR);
+      fillRowsCentered(col, row + d, row + dEnd, half, half, colorBGR);
+    }
+    d = dEnd + 1;
+  }
+}
+
+/** Fill a rectangle with rounded corners
+ *
+ *  The corner rows are spans inset by radius - chords[d]; the rows
+ *  between the corners are one rectangle.
+ */
+void fillRoundRect(u_char colMin, u_char rowMin, u_char width, u_char height,
+		   u_char radius, u_int colorBGR)
+{
+  u_char chords[ROUNDRECT_MAX_RADIUS + 1];
+  u_char d;
+  int colMid, halfLeft, halfRight, rowTop, rowBot;
+  
+  if (!width || !height)
+    return;
+  if (radius > ROUNDRECT_MAX_RADIUS)
+    radius = ROUNDRECT_MAX_RADIUS;
+  if (2 * radius > width)
+    radius = width >> 1;
+  if (2 * radius > height)
+    radius = height >> 1;
+  if (!radius) {
+    fillRectangle(colMin, rowMin, width, height, colorBGR);
+    return;
+  }
+  computeChordVec(chords, radius);
+
+  /* spans are measured from the left corner centers' column */
+  colMid = colMin + radius;
+  halfRight = width - 1 - radius;
+  rowTop = rowMin + radius;		 /* corner centers' rows */
+  rowBot = rowMin + height - 1 - radius;
+  
+  fillRowsCentered(colMid, rowTop, rowBot, radius, halfRight, colorBGR);
+  d = 1;
+  while (d <= radius) {
+    u_char dEnd = d, inset = radius - chords[d];
+    while (dEnd < radius && chords[dEnd + 1] == chords[d])
+      dEnd++;
+    halfLeft = radius - inset;
+    fillRowsCentered(colMid, rowTop - dEnd, rowTop - d,
+		     halfLeft, halfRight - inset, colorBGR);
+    fillRowsCentered(colMid, rowBot + d, rowBot + dEnd,
+		     halfLeft, halfRight - inset, colorBGR);
+    d = dEnd + 1;
+  }
+}
+
+/** Reads a sprite's pixel indices left to right (private) */
+typedef struct {
+  const u_char *byte;
+  u_char shift, bpp, mask;
+} SpriteCursor;
+
+/** Position cursor at pixel x of row y */
+static void
+spriteSeek(SpriteCursor *cur, const Sprite *sprite, u_char x, u_char y)
+{
+  u_char stride = ((u_int)sprite->width * sprite->bpp + 7) >> 3;
+  u_int bit = (u_int)x * sprite->bpp;
+  cur->bpp = sprite->bpp;
+  cur->mask = (1 << sprite->bpp) - 1;
+  cur->byte = sprite->data + (u_int)y * stride + (bit >> 3);
+  cur->shift = 8 - cur->bpp - (bit & 7);
+}
+
+/** Palette index of the next pixel */
+static inline u_char
+spriteNext(SpriteCursor *cur)
+{
+  u_char index = (*cur->byte >> cur->shift) & cur->mask;
+  if (cur->shift)
+    cur->shift -= cur->bpp;
+  else {
+    cur->shift = 8 - cur->bpp;
+    cur->byte++;
+  }
+  return index;
+}
+
+/** Visible part of a sprite: columns x0..x1-1 and rows y0..y1-1 of
+ *  the image.  Returns 0 if nothing is on screen. (private)
+ */
+static int
+spriteClip(int col, int row, const Sprite *sprite,
+	   u_char *x0, u_char *x1, u_char *y0, u_char *y1)
+{
+  int colEnd = col + sprite->width, rowEnd = row + sprite->height;
+  if (colEnd > screenWidth) colEnd = screenWidth;
+  if (rowEnd > screenHeight) rowEnd = screenHeight;
+  *x0 = col < 0 ? -col : 0;
+  *y0 = row < 0 ? -row : 0;
+  if (col + *x0 >= colEnd || row + *y0 >= rowEnd)
+    return 0;
+  *x1 = colEnd - col;
+  *y1 = rowEnd - row;
+  return 1;
+}
+
+/** Draw a sprite through one address window */
+void drawSprite(int col, int row, const Sprite *sprite)
+{
+  const u_int *palette = sprite->palette;
+  LcdRun run = {0, 0};
+  SpriteCursor cur;
+  u_char x0, x1, y0, y1, x, y;
+
+  if (!spriteClip(col, row, sprite, &x0, &x1, &y0, &y1))
+    return;
+  lcd_setArea(col + x0, row + y0, col + x1 - 1, row + y1 - 1);
+  for (y = y0; y < y1; y++) {
+    spriteSeek(&cur, sprite, x0, y);
+    for (x = x0; x < x1; x++)
+      lcd_runAdd(&run, palette[spriteNext(&cur)]);
+  }
+  lcd_runFlush(&run);
+}
+
+/** Draw a sprite's opaque pixels
+ *
+ *  A window is opened from the start of each span to the end of the
+ *  visible row; the span's pixels are written and the rest of the
+ *  window is abandoned at the next key pixel.
+ */
+void drawSpriteKeyed(int col, int row, const Sprite *sprite, u_char key)
+{
+  const u_int *palette = sprite->palette;
+  LcdRun run = {0, 0};
+  SpriteCursor cur;
+  u_char x0, x1, y0, y1, x, y, inSpan;
+
+  if (!spriteClip(col, row, sprite, &x0, &x1, &y0, &y1))
+    return;
+  for (y = y0; y < y1; y++) {
+    spriteSeek(&cur, sprite, x0, y);
+    inSpan = 0;
+    for (x = x0; x < x1; x++) {
+      u_char index = spriteNext(&cur);
+      if (index == key) {
+	if (inSpan)
+	  lcd_runFlush(&run);
+	inSpan = 0;
+	continue;
+      }
+      if (!inSpan) {
+	lcd_setArea(col + x, row + y, col + x1 - 1, row + y);
+	inSpan = 1;
+      }
+      lcd_runAdd(&run, palette[index]);
+    }
+    lcd_runFlush(&run);
+  }
+}
+
+/** Sort key of a point: row, then column (private) */
+static inline u_int
+pointKey(const PlotPoint *p)
+{
+  return ((u_int)p->row << 8) | p->col;
+}
+
+/** Sort points by row, then column; stable, so later points follow
+ *  earlier ones at the same position (private)
+ */
+static void
+sortPoints(PlotPoint *points, u_int count)
+{
+  u_int i, j;
+  for (i = 1; i < count; i++) {
+    PlotPoint p = points[i];
+    u_int key = pointKey(&p);
+    for (j = i; j && pointKey(&points[j-1]) > key; j--)
+      points[j] = points[j-1];
+    points[j] = p;
+  }
+}
+
+/** Draw a batch of points, one window per row where gaps allow and one
+ *  per vertical run of rows holding a single point in the same column
+ */
+void drawPoints(PlotPoint *points, u_int count, u_int bgColorBGR)
+{
+  LcdRun run = {0, 0};
+  u_int i = 0, j, k;
+
+  sortPoints(points, count);
+  while (i < count) {
+    u_char row = points[i].row, lastCol, next = 0, open = 0;
+    for (j = i; j < count && points[j].row == row; j++)
+      ;				/* row's points are i..j-1 */
+    if (j == i + 1) {		/* lone points in a column share a window */
+      while (j < count && points[j].col == points[i].col
+	     && points[j].row == row + (j - i)
+	     && (j + 1 == count || points[j+1].row != points[j].row))
+	j++;
+      lcd_setArea(points[i].col, row, points[i].col, row + (j - i) - 1);
+      for (k = i; k < j; k++)
+	lcd_runAdd(&run, points[k].colorBGR);
+      lcd_runFlush(&run);
+      i = j;
+      continue;
+    }
+    lastCol = points[j-1].col;
+    for (k = i; k < j; k++) {
+      const PlotPoint *p = &points[k];
+      if (k + 1 < j && points[k+1].col == p->col)
+	continue;		/* a later point covers this one */
+      if (open && p->col - next <= PLOT_GAP_MAX)
+	lcd_runAddCount(&run, bgColorBGR, p->col - next);
+      else {
+	lcd_runFlush(&run);
+	lcd_setArea(p->col, row, lastCol, row);
+	open = 1;
+      }
+      lcd_runAdd(&run, p->colorBGR);
+      next = p->col + 1;
+    }
+    lcd_runFlush(&run);
+    i = j;
+  }
+}
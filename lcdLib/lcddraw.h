@@ -23,16 +23,26 @@ void drawPixel(u_char col, u_char row, u_int colorBGR);
  */
 void fillRectangle(u_char colMin, u_char rowMin, u_char width, u_char height, u_int colorBGR);
 
+/** 16-bit coordinates
+ *
+ *  These take signed coordinates, draw only what is on the screen and
+ *  work on panels of more than 256 rows or columns (lcd_setArea16).
+ *  The drawString functions take the same coordinates.
+ */
+void drawPixel16(int col, int row, u_int colorBGR);
+void fillRectangle16(int colMin, int rowMin, int width, int height,
+		     u_int colorBGR);
+
 /** Clear screen (fill with color)
  *  
  *  \param colorBGR The color to fill screen
  */
 void clearScreen(u_int colorBGR);
 
-/** Draw string at col,row
- *  Type:
- *  FONT_SM - small (5x8,) FONT_MD - medium (8x12,) FONT_LG - large (11x16)
- *  FONT_SM_BKG, FONT_MD_BKG, FONT_LG_BKG - as above, but with background color
+/** Draw string at col,row using the 5x7 font
+ *  Glyphs are 5x8 with a 1-pixel gap (painted in bgColorBGR) between them.
+ *  Like the other drawString functions, the string is clipped at the
+ *  edge of the screen.
  *  Adapted from RobG's EduKit
  *
  *  \param col Column to start drawing string
@@ -41,15 +51,100 @@ void clearScreen(u_int colorBGR);
  *  \param fgColorBGR Foreground color in BGR
  *  \param bgColorBGR Background color in BGR
  */
-void drawString5x7(u_char col, u_char row, char *string, 
+void drawString5x7(int col, int row, char *string, 
 		   u_int fgColorBGR, u_int bgColorBGR);
 
+/** Draw string at col,row using the 8x12 font
+ *  Glyphs are 8x12 and include their own spacing.
+ *
+ *  \param col Column to start drawing string
+ *  \param row Row to start drawing string
+ *  \param string The string
+ *  \param fgColorBGR Foreground color in BGR
+ *  \param bgColorBGR Background color in BGR
+ */
+void drawString8x12(int col, int row, char *string,
+		    u_int fgColorBGR, u_int bgColorBGR);
+
+/** Draw string at col,row using the 11x16 font
+ *  Glyphs are 11x16 with a 1-pixel gap (painted in bgColorBGR) between them.
+ *
+ *  \param col Column to start drawing string
+ *  \param row Row to start drawing string
+ *  \param string The string
+ *  \param fgColorBGR Foreground color in BGR
+ *  \param bgColorBGR Background color in BGR
+ */
+void drawString11x16(int col, int row, char *string,
+		     u_int fgColorBGR, u_int bgColorBGR);
+
+/** As drawString8x12, but background pixels are left unchanged */
+void drawString8x12Transparent(int col, int row, char *string,
+			       u_int fgColorBGR);
+
+/** As drawString11x16, but background pixels are left unchanged */
+void drawString11x16Transparent(int col, int row, char *string,
+				u_int fgColorBGR);
+
+/** A bitmap font packed by makeFont (makeFont.c describes the format)
+ *
+ *  Glyphs are cropped to their foreground pixels, and a font may hold
+ *  only a subset of the printable characters.
+ */
+typedef struct {
+  u_char width, height, gap;	/**< cell size and spacing between glyphs */
+  u_char count;			/**< number of glyphs */
+  const char *chars;		/**< characters present, or 0 for all from 0x20 */
+  const u_int *offsets;		/**< start of each glyph in data */
+  const u_char *data;
+} PackedFont;
+
+/** Complete packed versions of the 8x12 and 11x16 fonts */
+extern const PackedFont font8x12Packed, font11x16Packed;
+
+/** Draw string at col,row using a packed font
+ *  Characters missing from the font are drawn blank.
+ *
+ *  \param col Column to start drawing string
+ *  \param row Row to start drawing string
+ *  \param string The string
+ *  \param font The packed font
+ *  \param fgColorBGR Foreground color in BGR
+ *  \param bgColorBGR Background color in BGR
+ */
+void drawStringPacked(u_char col, u_char row, char *string,
+		      const PackedFont *font, u_int fgColorBGR, u_int bgColorBGR);
+
 /** 5x7 font - this function draws background pixels
  *  Adapted from RobG's EduKit
  */
 void drawChar5x7(u_char col, u_char row, char c, 
 		 u_int fgColorBGR, u_int bgColorBGR);
 
+/** A line of 5x7 text that remembers what it last drew
+ *
+ *  textFieldUpdate redraws only the characters that differ from the
+ *  previous update, so it is cheap to call every frame.
+ */
+#define TEXTFIELD_MAX 16
+typedef struct {
+  u_char col, row;
+  u_int fgColorBGR, bgColorBGR;
+  u_char len;			/**< characters on screen */
+  char shown[TEXTFIELD_MAX];	/**< the characters on screen */
+} TextField;
+
+/** Set a text field's position and colors.  Nothing is drawn. */
+void textFieldInit(TextField *field, u_char col, u_char row,
+		   u_int fgColorBGR, u_int bgColorBGR);
+
+/** Show text (truncated to TEXTFIELD_MAX characters) in a field
+ *
+ *  Consecutive changed characters are drawn with one drawString5x7
+ *  call; characters beyond the new length are erased.
+ */
+void textFieldUpdate(TextField *field, const char *text);
+
 /** Draw rectangle outline
  *  
  *  \param colMin Column start
@@ -60,6 +155,107 @@ void drawChar5x7(u_char col, u_char row, char c,
  */
 void drawRectOutline(u_char colMin, u_char rowMin, u_char width, u_char height,
 		     u_int colorBGR);
+/** Draw a line between two points (inclusive)
+ *
+ *  Pixels that share a row (or, for steep lines, a column) are
+ *  filled as one span with a single address window.
+ *
+ *  \param col0, row0 First end point
+ *  \param col1, row1 Second end point
+ *  \param colorBGR Color of line in BGR
+ */
+void drawLine(u_char col0, u_char row0, u_char col1, u_char row1,
+	      u_int colorBGR);
+
+/** Build a table of circle half-widths
+ *
+ *  chordVec[d] becomes 1/2 the chord length at distance d from the
+ *  center, for d = 0..radius (radius + 1 entries).  circleLib's
+ *  generated chordVecN tables hold the same values.
+ */
+void computeChordVec(u_char chordVec[], u_char radius);
+
+/** Fill a circle, one span per distinct row width
+ *
+ *  Parts outside the screen are clipped.
+ *
+ *  \param col, row Center
+ *  \param radius Radius
+ *  \param chords Half-widths from computeChordVec (radius + 1 entries)
+ *  \param colorBGR Color of circle in BGR
+ */
+void fillCircle(u_char col, u_char row, u_char radius, const u_char *chords,
+		u_int colorBGR);
+
+#define ROUNDRECT_MAX_RADIUS 15	/**< bounds fillRoundRect's chord table */
+
+/** Fill a rectangle with rounded corners
+ *
+ *  radius is reduced to half the shorter side and to
+ *  ROUNDRECT_MAX_RADIUS.
+ *
+ *  \param colMin Column start
+ *  \param rowMin Row start
+ *  \param width Width of rectangle
+ *  \param height Height of rectangle
+ *  \param radius Corner radius
+ *  \param colorBGR Color of rectangle in BGR
+ */
+void fillRoundRect(u_char colMin, u_char rowMin, u_char width, u_char height,
+		   u_char radius, u_int colorBGR);
+/** A palette-indexed image, normally a const (flash) array
+ *
+ *  Each pixel is a bpp-bit index into palette.  Rows start on a byte
+ *  boundary; within a byte the leftmost pixel is in the high bits.
+ */
+typedef struct {
+  u_char width, height;
+  u_char bpp;			/**< bits per pixel: 1, 2 or 4 */
+  const u_int *palette;		/**< 1 << bpp colors in BGR */
+  const u_char *data;		/**< height rows of (width * bpp + 7) / 8 bytes */
+} Sprite;
+
+/** Draw a sprite with its top left corner at col,row
+ *
+ *  The sprite is clipped to the screen, so col and row may be
+ *  negative.  The visible part is written through one address window.
+ *
+ *  \param col Column of the sprite's left edge
+ *  \param row Row of the sprite's top edge
+ *  \param sprite The sprite
+ */
+void drawSprite(int col, int row, const Sprite *sprite);
+
+/** As drawSprite, but pixels with palette index key are left
+ *  unchanged.  Each row is written as spans of opaque pixels.
+ */
+void drawSpriteKeyed(int col, int row, const Sprite *sprite, u_char key);
+/** A point for drawPoints */
+typedef struct {
+  u_char col, row;
+  u_int colorBGR;
+} PlotPoint;
+
+/** Gaps of up to this many pixels between points on a row are filled
+ *  with the background color: that costs no more than the 6 bytes
+ *  (CASET and RAMWR) of a new window.
+ */
+#define PLOT_GAP_MAX 3
+
+/** Draw a batch of points
+ *
+ *  Points are sorted by row and column (points is reordered) and each
+ *  row is drawn through as few windows as possible: points with at
+ *  most PLOT_GAP_MAX pixels between them share a window, the pixels
+ *  between them painted bgColorBGR.  Consecutive rows that each hold one point in
+ *  the same column (a vertical line) share one window.  Where two
+ *  points coincide, the later one in the array is drawn.
+ *
+ *  \param points The points
+ *  \param count Number of points
+ *  \param bgColorBGR Color of pixels between merged points
+ */
+void drawPoints(PlotPoint *points, u_int count, u_int bgColorBGR);
 #endif // included
 
 
@@ -0,0 +1,11 @@
+/** \file lcddriver.c
+ *  \brief The ST7735 as an LcdDriver
+ */
+#include "lcddriver.h"
+
+const LcdDriver lcdSt7735Driver = {
+  lcd_setArea16, lcd_writeColor, lcd_writeColorRun, lcd_flush,
+  screenWidth, screenHeight, 0
+};
+
+const LcdDriver *lcdDriver = &lcdSt7735Driver;
@@ -0,0 +1,85 @@
+/** \file lcddriver.h
+ *  \brief Display drivers behind a common interface
+ *
+ *  Renderers (e.g. shapeLib's layerDraw) draw through lcdDriver, so
+ *  the same code can target the ST7735 or a monochrome framebuffer
+ *  panel (lcdmono.h).
+ */
+
+#ifndef lcddriver_included
+#define lcddriver_included
+
+#include "lcdutils.h"
+#include "lcdcapture.h"
+
+/** Driver capabilities (LcdDriver.caps) */
+#define LCD_CAP_FLUSH   0x01	/**< pixels reach the panel only at flush */
+#define LCD_CAP_CHEAPWIN 0x02	/**< windows cost nothing (no bus traffic) */
+
+/** A display driver
+ *
+ *  Pixels are streamed row by row into a window, as with lcd_setArea
+ *  and lcd_writeColor.  Windows must lie within width x height.
+ */
+typedef struct {
+  void (*window)(u_int colStart, u_int rowStart, u_int colEnd, u_int rowEnd);
+  void (*stream)(u_int colorBGR);	      /**< next pixel */
+  void (*run)(u_int colorBGR, u_int count); /**< next count pixels, one color */
+  void (*flush)();			      /**< show everything drawn so far */
+  u_int width, height;			      /**< panel size */
+  u_char caps;				      /**< LCD_CAP_... */
+} LcdDriver;
+
+/** The ST7735 (lcdutils.h) */
+extern const LcdDriver lcdSt7735Driver;
+
+/** Driver used by renderers; initially &lcdSt7735Driver */
+extern const LcdDriver *lcdDriver;
+
+/** Append one pixel to run, writing the previous run through lcdDriver
+ *  if the color changed or the count would overflow (cf. lcd_runAdd)
+ */
+static inline void
+drv_runAdd(LcdRun *run, u_int colorBGR)
+{
+  if (run->count && (run->color != colorBGR || run->count == 0xffff)) {
+    lcdDriver->run(run->color, run->count);
+    run->count = 0;
+  }
+  run->color = colorBGR;
+  run->count++;
+}
+
+/** Append count pixels of one color to run (cf. drv_runAdd) */
+static inline void
+drv_runAddCount(LcdRun *run, u_int colorBGR, u_int count)
+{
+  if (run->count && (run->color != colorBGR || run->count > 0xffff - count)) {
+    lcdDriver->run(run->color, run->count);
+    run->count = 0;
+  }
+  run->color = colorBGR;
+  run->count += count;
+}
+
+/** Write out any pending pixels of run through lcdDriver */
+static inline void
+drv_runFlush(LcdRun *run)
+{
+  if (run->count)
+    lcdDriver->run(run->color, run->count);
+  run->count = 0;
+}
+
+/** End of a frame: flush drivers that only draw on flush, and mark
+ *  the frame in a capture
+ */
+static inline void
+drv_frameDone()
+{
+  if (lcdDriver->caps & LCD_CAP_FLUSH)
+    lcdDriver->flush();
+  lcdcapture_frame();
+}
+
+#endif // included
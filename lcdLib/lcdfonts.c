@@ -0,0 +1,115 @@
+/** \file lcdfonts.c
+ *  \brief String renderers for the 8x12 and 11x16 fonts
+ *
+ *  Kept apart from lcddraw.c so that only programs drawing with these
+ *  fonts link in their tables (about 3 KB of flash).
+ */
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "_lcdfont.h"
+
+/** 8x12 glyphs are stored as 12 rows, bit 7 at the left */
+static u_int
+rowBits8x12(char c, u_char row)
+{
+  return font_8x12[c - 0x20][row];
+}
+
+/** 11x16 glyphs are stored as 11 columns, bit 0 at the top */
+static u_int
+rowBits11x16(char c, u_char row)
+{
+  const u_int *glyph = font_11x16[c - 0x20];
+  u_int bit = 1 << row, bits = 0;
+  u_char i;
+  for (i = 0; i < 11; i++)
+    bits = (bits << 1) | ((glyph[i] & bit) != 0);
+  return bits;
+}
+
+static const Font font8x12 = {8, 12, 0, rowBits8x12};
+static const Font font11x16 = {11, 16, 1, rowBits11x16};
+
+/** Write the foreground columns start..end-1 of a row, clipped to
+ *  the screen's width (private)
+ */
+static void
+writeSpan(int start, int end, int row, u_int fgColorBGR)
+{
+  if (start < 0)
+    start = 0;
+  if (end > screenWidth)
+    end = screenWidth;
+  if (start < end)
+    lcd_writeRowSpan(start, row, end - start, fgColorBGR);
+}
+
+/** Draw only the foreground pixels of a string (private)
+ *
+ *  Each row's foreground spans (which may continue across glyphs)
+ *  are written as single-row runs.  Pixels off the screen are
+ *  skipped.
+ */
+static void
+drawStringFontTransparent(int col, int row, const char *string,
+			  const Font *font, u_int fgColorBGR)
+{
+  u_char r, i, inSpan;
+  int x, spanStart = 0;
+  const char *s;
+
+  for (r = 0; r < font->height && row + r < screenHeight; r++) {
+    if (row + r < 0)
+      continue;
+    x = col;
+    inSpan = 0;
+    for (s = string; *s && x < screenWidth; s++) {
+      u_int bits = font->rowBits(*s, r);
+      for (i = font->width; i--; x++) {
+	if ((bits >> i) & 1) {
+	  if (!inSpan)
+	    spanStart = x;
+	  inSpan = 1;
+	} else if (inSpan) {
+	  writeSpan(spanStart, x, row + r, fgColorBGR);
+	  inSpan = 0;
+	}
+      }
+      if (font->gap && inSpan) {
+	writeSpan(spanStart, x, row + r, fgColorBGR);
+	inSpan = 0;
+      }
+      x += font->gap;
+    }
+    if (inSpan)
+      writeSpan(spanStart, x, row + r, fgColorBGR);
+  }
+}
+
+/** Draw string at col,row using the 8x12 font */
+void drawString8x12(int col, int row, char *string,
+		    u_int fgColorBGR, u_int bgColorBGR)
+{
+  _drawStringFont(col, row, string, &font8x12, fgColorBGR, bgColorBGR);
+}
+
+/** Draw string at col,row using the 11x16 font */
+void drawString11x16(int col, int row, char *string,
+		     u_int fgColorBGR, u_int bgColorBGR)
+{
+  _drawStringFont(col, row, string, &font11x16, fgColorBGR, bgColorBGR);
+}
+
+/** Draw the foreground of a string using the 8x12 font */
+void drawString8x12Transparent(int col, int row, char *string,
+			       u_int fgColorBGR)
+{
+  drawStringFontTransparent(col, row, string, &font8x12, fgColorBGR);
+}
+
+/** Draw the foreground of a string using the 11x16 font */
+void drawString11x16Transparent(int col, int row, char *string,
+				u_int fgColorBGR)
+{
+  drawStringFontTransparent(col, row, string, &font11x16, fgColorBGR);
+}
@@ -0,0 +1,115 @@
+/** \file lcdmono.c
+ *  \brief 1-bpp framebuffer driver (see lcdmono.h)
+ */
+#include "lcdmono.h"
+
+static u_char fb[MONO_PAGES][MONO_WIDTH];
+static u_char dirtyColMin[MONO_PAGES], dirtyColMax[MONO_PAGES];
+static u_char dirtyPages;	/**< bit p: page p has changed bytes */
+static MonoPageSink pageSink;
+
+/** Window and write position */
+static struct {
+  u_char colStart, colEnd, rowEnd;
+  u_char col, row;
+} cur;
+
+static void
+monoWindow(u_int colStart, u_int rowStart, u_int colEnd, u_int rowEnd)
+{
+  cur.colStart = cur.col = colStart;
+  cur.colEnd = colEnd;
+  cur.row = rowStart;
+  cur.rowEnd = rowEnd;
+}
+
+/** Set or clear n pixels of the current row from the write position,
+ *  marking the page dirty where a byte changes (private)
+ */
+static void
+monoSpan(u_char lit, u_char n)
+{
+  u_char page = cur.row >> 3, mask = 1 << (cur.row & 7);
+  u_char col = cur.col, colEnd = col + n - 1, *p;
+  u_char changedMin = 0xff, changedMax = 0;
+
+  if (cur.row >= MONO_HEIGHT || col >= MONO_WIDTH)
+    return;
+  if (colEnd >= MONO_WIDTH)
+    colEnd = MONO_WIDTH - 1;
+  for (p = &fb[page][col]; col <= colEnd; col++, p++) {
+    u_char b = lit ? (*p | mask) : (*p & ~mask);
+    if (b != *p) {
+      *p = b;
+      if (changedMin == 0xff)
+	changedMin = col;
+      changedMax = col;
+    }
+  }
+  if (changedMin == 0xff)
+    return;
+  if (!(dirtyPages & (1 << page))) {
+    dirtyPages |= 1 << page;
+    dirtyColMin[page] = changedMin;
+    dirtyColMax[page] = changedMax;
+  } else {
+    if (changedMin < dirtyColMin[page]) dirtyColMin[page] = changedMin;
+    if (changedMax > dirtyColMax[page]) dirtyColMax[page] = changedMax;
+  }
+}
+
+/** Fill count pixels, one row segment at a time */
+static void
+monoRun(u_int colorBGR, u_int count)
+{
+  u_char lit = MONO_LIT(colorBGR);
+  while (count && cur.row <= cur.rowEnd) {
+    u_int n = cur.colEnd - cur.col + 1; /**< left on this row */
+    if (n > count)
+      n = count;
+    monoSpan(lit, n);
+    count -= n;
+    cur.col += n;
+    if (cur.col > cur.colEnd) {
+      cur.col = cur.colStart;
+      cur.row++;
+    }
+  }
+}
+
+static void
+monoStream(u_int colorBGR)
+{
+  monoRun(colorBGR, 1);
+}
+
+static void
+monoFlush()
+{
+  u_char page;
+  for (page = 0; page < MONO_PAGES; page++) {
+    if (!(dirtyPages & (1 << page)))
+      continue;
+    if (pageSink)
+      pageSink(page, dirtyColMin[page], dirtyColMax[page],
+	       &fb[page][dirtyColMin[page]]);
+  }
+  dirtyPages = 0;
+}
+
+const LcdDriver lcdMonoDriver = {
+  monoWindow, monoStream, monoRun, monoFlush,
+  MONO_WIDTH, MONO_HEIGHT, LCD_CAP_FLUSH | LCD_CAP_CHEAPWIN
+};
+
+void lcdmono_setPageSink(MonoPageSink sink)
+{
+  pageSink = sink;
+}
+
+u_char lcdmono_getPixel(u_char col, u_char row)
+{
+  if (col >= MONO_WIDTH || row >= MONO_HEIGHT)
+    return 0;
+  return (fb[row >> 3][col] >> (row & 7)) & 1;
+}
@@ -0,0 +1,53 @@
+/** \file lcdmono.h
+ *  \brief A 1-bit-per-pixel framebuffer driver for SSD1306-style panels
+ *
+ *  Pixels are drawn into local memory laid out as the SSD1306 expects
+ *  it: MONO_HEIGHT / 8 pages, each a row of MONO_WIDTH bytes whose
+ *  bits are 8 vertically adjacent pixels (bit 0 on top).  Only bytes
+ *  that change mark their page dirty, and lcdMonoDriver.flush hands
+ *  the changed columns of each dirty page to a page sink.
+ *
+ *  The framebuffer takes MONO_WIDTH * MONO_HEIGHT / 8 bytes: 1 KB for
+ *  a 128x64 panel, more than the msp430g2553's 512 bytes of RAM.  Use
+ *  a part with more RAM, or define a smaller MONO_HEIGHT.
+ */
+
+#ifndef lcdmono_included
+#define lcdmono_included
+
+#include "lcddriver.h"
+
+#ifndef MONO_WIDTH
+#define MONO_WIDTH 128
+#endif
+#ifndef MONO_HEIGHT
+#define MONO_HEIGHT 64		/**< multiple of 8, at most 64 */
+#endif
+#define MONO_PAGES (MONO_HEIGHT / 8)
+
+/** The monochrome framebuffer driver.  Colors are thresholded with
+ *  MONO_LIT.
+ */
+extern const LcdDriver lcdMonoDriver;
+
+/** Whether a pixel of color c is lit: the top bit of its blue, green
+ *  or red channel is set
+ */
+#define MONO_LIT(c) (((c) & 0x8410) != 0)
+
+/** Receives changed bytes at flush
+ *
+ *  For an SSD1306 this sets the page (0xB0 | page) and start column
+ *  (0x00 | low nibble, 0x10 | high nibble) and sends the
+ *  colEnd - colStart + 1 bytes as data.
+ */
+typedef void (*MonoPageSink)(u_char page, u_char colStart, u_char colEnd,
+			     const u_char *bytes);
+
+/** Set the page sink (initially none: flush only clears dirty marks) */
+void lcdmono_setPageSink(MonoPageSink sink);
+
+/** Whether the pixel at col, row is lit (for tests and host tools) */
+u_char lcdmono_getPixel(u_char col, u_char row);
+
+#endif // included
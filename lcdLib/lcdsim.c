@@ -0,0 +1,389 @@
+/** \file lcdsim.c
+ *  \brief Emulated ST7735 implementing _lcdbus.h for host builds
+ *
+ *  Decodes the command stream that lcdutils.c would send over SPI:
+ *  CASET/PASET windows, RAMWR with auto-increment, MADCTL orientation
+ *  and COLMOD pixel formats (12, 16 and 18 bpp).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "_lcdbus.h"
+#include "lcdsim.h"
+
+#define MEM_COLS SHORT_EDGE_PIXELS
+#define MEM_ROWS LONG_EDGE_PIXELS
+
+/** MADCTL bits */
+#define MADCTL_MY  0x80
+#define MADCTL_MX  0x40
+#define MADCTL_MV  0x20
+#define MADCTL_BGR 0x08
+
+LcdSimStats lcdsimStats;
+
+static unsigned short mem[MEM_ROWS][MEM_COLS]; /**< display RAM */
+
+static u_char cmd;		/**< command whose data is being received */
+static u_char params[6], nParams;
+static u_char madctl, colmod;
+static u_int xs, xe, ys, ye;	/**< address window */
+static u_int wcol, wrow;	/**< RAMWR write pointer */
+static u_char pixBytes[3], nPixBytes;
+static int frame;
+static unsigned long busBytes;	/**< bytes sent, for capture timestamps */
+static u_char *captureBuf;	/**< LCDSIM_TRACE capture */
+static u_int tfa, vsa, vsp;	/**< scrolling area and start line */
+static int scrolling;
+
+/** Power-on / SWRESET state */
+static void
+simReset()
+{
+  madctl = 0;
+  colmod = 0x06;
+  xs = ys = 0;
+  xe = MEM_COLS - 1;
+  ye = MEM_ROWS - 1;
+  cmd = 0;
+  tfa = 0;
+  vsa = MEM_ROWS;
+  vsp = 0;
+  scrolling = 0;
+}
+
+/** Display RAM row shown on display line y (vertical scrolling) */
+static u_int
+scrollMap(u_int y)
+{
+  if (!scrolling || y < tfa || y >= tfa + vsa)
+    return y;
+  y += vsp - tfa;
+  return y >= tfa + vsa ? y - vsa : y;
+}
+
+/** Map screen coordinates to display RAM according to MADCTL
+ *
+ *  If display is set, the result is the RAM shown at that position
+ *  rather than the RAM written by that address.
+ */
+static unsigned short *
+memAt(u_int col, u_int row, int display)
+{
+  u_int x = col, y = row;
+  if (madctl & MADCTL_MV) {
+    x = row;
+    y = col;
+  }
+  if (x >= MEM_COLS || y >= MEM_ROWS)
+    return 0;
+  if (madctl & MADCTL_MX)
+    x = MEM_COLS - 1 - x;
+  if (madctl & MADCTL_MY)
+    y = MEM_ROWS - 1 - y;
+  if (display)
+    y = scrollMap(y);
+  return &mem[y][x];
+}
+
+/** Store one pixel at the write pointer and advance it */
+static void
+storePixel(u_int colorBGR)
+{
+  unsigned short *p = memAt(wcol, wrow, 0);
+  if (p) {
+    if (*p == colorBGR)
+      lcdsimStats.unchanged++;
+    *p = colorBGR;
+  }
+  lcdsimStats.pixels++;
+  if (++wcol > xe) {
+    wcol = xs;
+    if (++wrow > ye)
+      wrow = ys;
+  }
+}
+
+/** Expand an n-bit channel to 5 or 6 bits */
+#define EXPAND4TO5(v) (((v) << 1) | ((v) >> 3))
+#define EXPAND4TO6(v) (((v) << 2) | ((v) >> 2))
+
+static u_int
+from444(u_int c)
+{
+  u_int b = (c >> 8) & 0xf, g = (c >> 4) & 0xf, r = c & 0xf;
+  return (EXPAND4TO5(b) << 11) | (EXPAND4TO6(g) << 5) | EXPAND4TO5(r);
+}
+
+/** Accumulate a pixel data byte in the current COLMOD format */
+static void
+pixelByte(u_char b)
+{
+  lcdsimStats.pixelBytes++;
+  pixBytes[nPixBytes++] = b;
+  switch (colmod & 0x07) {
+  case 0x03:			/* 12 bpp: 3 bytes carry 2 pixels */
+    if (nPixBytes == 2)
+      storePixel(from444((pixBytes[0] << 4) | (pixBytes[1] >> 4)));
+    else if (nPixBytes == 3) {
+      storePixel(from444(((pixBytes[1] & 0xf) << 8) | pixBytes[2]));
+      nPixBytes = 0;
+    }
+    break;
+  case 0x05:			/* 16 bpp */
+    if (nPixBytes == 2) {
+      storePixel((pixBytes[0] << 8) | pixBytes[1]);
+      nPixBytes = 0;
+    }
+    break;
+  default:			/* 18 bpp: upper 6 bits of each byte */
+    if (nPixBytes == 3) {
+      storePixel(((pixBytes[0] >> 3) << 11) | ((pixBytes[1] >> 2) << 5)
+		 | (pixBytes[2] >> 3));
+      nPixBytes = 0;
+    }
+  }
+}
+
+/** Accumulate a command parameter, applying the command when complete */
+static void
+paramByte(u_char b)
+{
+  lcdsimStats.paramBytes++;
+  if (nParams < sizeof(params))
+    params[nParams++] = b;
+  switch (cmd) {
+  case CASETP:
+    if (nParams == 4) {
+      xs = (params[0] << 8) | params[1];
+      xe = (params[2] << 8) | params[3];
+    }
+    break;
+  case PASETP:
+    if (nParams == 4) {
+      ys = (params[0] << 8) | params[1];
+      ye = (params[2] << 8) | params[3];
+    }
+    break;
+  case MADCTL:
+    madctl = b;
+    break;
+  case VSCRDEF:
+    if (nParams == 6) {
+      tfa = (params[0] << 8) | params[1];
+      vsa = (params[2] << 8) | params[3];
+    }
+    break;
+  case VSCRSADD:
+    if (nParams == 2) {
+      vsp = (params[0] << 8) | params[1];
+      scrolling = 1;
+    }
+    break;
+  case COLMOD:
+    colmod = b;
+    break;
+  }
+}
+
+#define CAPTURE_SIZE (16u << 20)	/**< LCDSIM_TRACE buffer */
+
+static void
+simExit()
+{
+  lcdsim_endFrame();
+  if (captureBuf) {
+    u_int used = lcdcapture_stop();
+    FILE *fp = fopen(getenv("LCDSIM_TRACE"), "wb");
+    if (fp) {
+      fwrite(captureBuf, 1, used, fp);
+      fclose(fp);
+    }
+    if (lcdCaptureOverflow)
+      fprintf(stderr, "lcdsim: capture truncated at %u bytes\n", used);
+  }
+}
+
+void
+_setUpBus()
+{
+  static int registered;
+  if (!registered) {
+    atexit(simExit);
+    registered = 1;
+    if (getenv("LCDSIM_TRACE") && (captureBuf = malloc(CAPTURE_SIZE)))
+      lcdcapture_start(captureBuf, CAPTURE_SIZE, LCDCAPTURE_TIMESTAMPS);
+  }
+  simReset();
+}
+
+void
+_writeCommand(u_char command)
+{
+  if (lcdCaptureOn)
+    _captureCommand(command);
+  lcdsimStats.commands++;
+  busBytes++;
+  cmd = command;
+  nParams = nPixBytes = 0;
+  switch (command) {
+  case SWRESET:
+    simReset();
+    break;
+  case NORON:
+    scrolling = 0;
+    break;
+  case RAMWRP:
+    wcol = xs;
+    wrow = ys;
+    break;
+  }
+}
+
+/** Decode one data byte (private) */
+static void
+dataByte(u_char data)
+{
+  busBytes++;
+  if (cmd == RAMWRP)
+    pixelByte(data);
+  else
+    paramByte(data);
+}
+
+void
+_writeData(u_char data)
+{
+  if (lcdCaptureOn)
+    _captureData(data);
+  dataByte(data);
+}
+
+void
+_writeDataRun(u_char hi, u_char lo, u_int count)
+{
+  if (lcdCaptureOn)
+    _captureRun(hi, lo, count);
+  while (count--) {
+    dataByte(hi);
+    dataByte(lo);
+  }
+}
+
+void
+_writeDataRun3(u_char b0, u_char b1, u_char b2, u_int count)
+{
+  if (lcdCaptureOn)
+    _captureRun3(b0, b1, b2, count);
+  while (count--) {
+    dataByte(b0);
+    dataByte(b1);
+    dataByte(b2);
+  }
+}
+
+void
+_flush()
+{
+}
+
+void
+_delay(u_char x10ms)
+{
+  lcdsimStats.delayMs += x10ms * 10;
+  busBytes += x10ms * 2500;	/**< 10 ms in 4 us byte times */
+}
+
+/** Emulated capture clock: one tick per byte on the bus (4 us at
+ *  2 MHz) plus delays
+ */
+int
+_captureClockStart()
+{
+  return 1;
+}
+
+u_int
+_captureClock()
+{
+  return busBytes;
+}
+
+/** Host delays elapse at once */
+void
+_startDelay(u_char x10ms, void (*done)())
+{
+  _delay(x10ms);
+  done();
+}
+
+void
+_sleepUntil(volatile u_char *flag)
+{
+  (void)flag;			/* _startDelay finished the delay already */
+}
+
+void
+lcdsim_resetStats()
+{
+  LcdSimStats zero = {0};
+  lcdsimStats = zero;
+}
+
+u_int
+lcdsim_getPixel(u_int col, u_int row)
+{
+  unsigned short *p = memAt(col, row, 1);
+  return p ? *p : 0;
+}
+
+int
+lcdsim_writePPM(const char *path)
+{
+  int x, y;
+  FILE *fp = fopen(path, "wb");
+  if (!fp)
+    return -1;
+  fprintf(fp, "P6\n%d %d\n255\n", MEM_COLS, MEM_ROWS);
+  for (y = 0; y < MEM_ROWS; y++) {
+    for (x = 0; x < MEM_COLS; x++) {
+      u_int c = mem[scrollMap(y)][x];
+      u_int hi5 = c >> 11, g6 = (c >> 5) & 0x3f, lo5 = c & 0x1f;
+      u_int r = (madctl & MADCTL_BGR) ? lo5 : hi5;
+      u_int b = (madctl & MADCTL_BGR) ? hi5 : lo5;
+      putc((r << 3) | (r >> 2), fp);
+      putc((g6 << 2) | (g6 >> 4), fp);
+      putc((b << 3) | (b >> 2), fp);
+    }
+  }
+  return fclose(fp);
+}
+
+void
+lcdsim_getWindow(u_int *colStart, u_int *rowStart, u_int *colEnd, u_int *rowEnd)
+{
+  *colStart = xs;
+  *rowStart = ys;
+  *colEnd = xe;
+  *rowEnd = ye;
+}
+
+void
+lcdsim_endFrame()
+{
+  lcdcapture_frame();
+  const char *ppm = getenv("LCDSIM_PPM");
+  if (ppm) {
+    char path[256];
+    snprintf(path, sizeof(path), ppm, frame);
+    lcdsim_writePPM(path);
+  }
+  if (getenv("LCDSIM_STATS"))
+    fprintf(stderr, "frame %d: %lu commands, %lu param bytes, "
+	    "%lu pixel bytes, %lu pixels (%lu unchanged), %lu ms delay\n",
+	    frame, lcdsimStats.commands, lcdsimStats.paramBytes,
+	    lcdsimStats.pixelBytes, lcdsimStats.pixels, lcdsimStats.unchanged,
+	    lcdsimStats.delayMs);
+  lcdsim_resetStats();
+  frame++;
+}
@@ -0,0 +1,52 @@
+/** \file lcdsim.h
+ *  \brief Host-side ST7735 emulator (lcdsim.c)
+ *
+ *  Linking libLcdHost.a instead of libLcd.a runs lcdLib on the host:
+ *  every command and data byte is decoded by an emulated controller
+ *  with a 128x160 framebuffer.
+ *
+ *  Environment variables read at exit and by lcdsim_endFrame:
+ *   - LCDSIM_PPM: write the screen to this file (may contain %d for
+ *     the frame number)
+ *   - LCDSIM_STATS: print byte counts to stderr
+ *   - LCDSIM_TRACE: capture the command stream (lcdcapture.h) into
+ *     this file, for lcdtrace
+ */
+
+#ifndef lcdsim_included
+#define lcdsim_included
+
+#include "lcdutils.h"
+
+/** Byte counts since the last lcdsim_resetStats() */
+typedef struct {
+  unsigned long commands;	/**< command bytes */
+  unsigned long paramBytes;	/**< data bytes that were command parameters */
+  unsigned long pixelBytes;	/**< data bytes written after RAMWR */
+  unsigned long pixels;		/**< pixels stored in display RAM */
+  unsigned long unchanged;	/**< pixels stored with the color they had */
+  unsigned long delayMs;	/**< time requested via _delay */
+} LcdSimStats;
+
+extern LcdSimStats lcdsimStats;
+
+/** Clear lcdsimStats */
+void lcdsim_resetStats();
+
+/** Report and reset per-frame statistics
+ *
+ *  Writes LCDSIM_PPM and prints lcdsimStats if requested, then resets
+ *  the counters and advances the frame number.
+ */
+void lcdsim_endFrame();
+
+/** Color currently displayed at col,row (screen coordinates) */
+u_int lcdsim_getPixel(u_int col, u_int row);
+
+/** The controller's current address window (display RAM coordinates) */
+void lcdsim_getWindow(u_int *colStart, u_int *rowStart, u_int *colEnd, u_int *rowEnd);
+
+/** Write the screen as a binary PPM.  Returns 0 on success. */
+int lcdsim_writePPM(const char *path);
+
+#endif // included
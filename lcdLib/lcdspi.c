@@ -0,0 +1,297 @@
+/** \file lcdspi.c
+ *  \brief SPI transport for the onboard LCD (see _lcdbus.h)
+ *
+ *  Split out of lcdutils.c, which is
+ *  Created on: 10/19/2016
+ *  Author: Eric Freudenthal & David Pruitt
+ *  Derived from EduKit code by RobG
+ *  Chip select: P1.0
+ *  Data/Cmd: P1.4
+ */
+ 
+#include "msp430.h"
+#include "libTimer.h"
+#include "_lcdbus.h"
+
+/** LCD pin definitions*/
+/** SCLK & MOSI*/
+#define LCD_SPI_OUT		P1OUT
+#define LCD_SPI_DIR		P1DIR
+#define LCD_SPI_SEL		P1SEL
+#define LCD_SPI_SEL2	P1SEL2
+#define LCD_SCLK_PIN	BIT5
+#define LCD_MOSI_PIN	BIT7
+
+/** Chip select */
+#define LCD_CS_PIN	BIT0
+#define LCD_CS_DIR	P1DIR
+#define LCD_CS_OUT	P1OUT
+
+/** CS convenience defines */
+#define LCD_SELECT() LCD_CS_OUT &= ~LCD_CS_PIN
+#define LCD_DESELECT()
+
+/** Data/command */
+#define LCD_DC_PIN	BIT4
+#define LCD_DC_DIR	P1DIR
+#define LCD_DC_OUT	P1OUT
+
+/** D/C convenience defines */
+#define LCD_DC_LO() LCD_DC_OUT &= ~LCD_DC_PIN
+#define LCD_DC_HI() LCD_DC_OUT |= LCD_DC_PIN
+
+/** Set up onboard LCD's SPI and control pins */
+void _setUpBus() {
+  LCD_DC_OUT |= LCD_DC_PIN;
+  LCD_DC_DIR |= LCD_DC_PIN;
+  
+  LCD_CS_OUT |= LCD_CS_PIN;
+  LCD_CS_DIR |= LCD_CS_PIN;
+  
+  LCD_SPI_OUT |= LCD_SCLK_PIN;
+  LCD_SPI_DIR |= LCD_SCLK_PIN;
+  LCD_SPI_OUT |= LCD_MOSI_PIN;
+  LCD_SPI_DIR |= LCD_MOSI_PIN;
+  LCD_SPI_SEL |= LCD_SCLK_PIN + LCD_MOSI_PIN;
+  LCD_SPI_SEL2 |= LCD_SCLK_PIN + LCD_MOSI_PIN;
+  
+  UCB0CTL1 |= UCSWRST;
+  UCB0CTL0 = UCCKPH + UCMSB + UCMST + UCSYNC; /**< 3-pin, 8-bit SPI master */
+  UCB0CTL1 |= UCSSEL_2; /**< SMCLK */
+  UCB0BR0 |= 0x01; /**< 1:1 */
+  UCB0BR1 = 0;
+  UCB0CTL1 &= ~UCSWRST;
+  LCD_SELECT();
+}
+
+/** Transmit queue
+ *
+ *  Data bytes are queued here and shifted out by the USCI_B0 TX
+ *  interrupt so that callers can compute the next pixels while the
+ *  previous ones are still on the wire.  Commands bypass the queue
+ *  (see _writeCommand) since D/C may only change when the bus is idle.
+ */
+#define TXQ_SIZE 32			/**< must be a power of 2 */
+#define TXQ_MASK (TXQ_SIZE - 1)
+#define LCD_RUN_DIRECT 8		/**< shorter runs go through the queue */
+
+static u_char txq[TXQ_SIZE];
+static volatile u_char txqHead, txqTail;  /**< enqueue at head, dequeue at tail */
+static volatile u_char txqSleeping;	  /**< CPU is in LPM0 waiting on the queue */
+
+/** Wait for the tx interrupt to consume at least one queued byte (private)
+ *
+ *  Sleeps in LPM0 if interrupts are enabled.  Otherwise (e.g. when
+ *  drawing from an interrupt handler) the oldest byte is sent by
+ *  polling so the queue cannot deadlock.
+ */
+static void
+txqWait()
+{
+  if (__get_SR_register() & GIE) {
+    __disable_interrupt();
+    if (txqHead != txqTail) {
+      txqSleeping = 1;
+      __bis_SR_register(CPUOFF | GIE); /**< woken by lcd_txInterrupt */
+    } else
+      __enable_interrupt();
+  } else {
+    while (!(IFG2 & UCB0TXIFG));
+    UCB0TXBUF = txq[txqTail];
+    txqTail = (txqTail + 1) & TXQ_MASK;
+  }
+}
+
+/** USCI_B0 transmit interrupt: shift out the next queued byte */
+void
+__interrupt_vec(USCIAB0TX_VECTOR) lcd_txInterrupt()
+{
+  if (txqHead != txqTail) {
+    UCB0TXBUF = txq[txqTail];
+    txqTail = (txqTail + 1) & TXQ_MASK;
+  }
+  if (txqHead == txqTail)
+    IE2 &= ~UCB0TXIE;		/**< nothing left to send */
+  if (txqSleeping) {
+    txqSleeping = 0;
+    __bic_SR_register_on_exit(CPUOFF);
+  }
+}
+
+/** Queue one data byte (private) */
+static void
+enqueue(u_char data) 
+{
+  u_char next = (txqHead + 1) & TXQ_MASK;
+  while (next == txqTail)	/**< queue full */
+    txqWait();
+  txq[txqHead] = data;
+  txqHead = next;
+  IE2 |= UCB0TXIE;		/**< (re)start the tx interrupt */
+}
+
+/** Write data to LCD (queued) */
+void 
+_writeData(u_char data) 
+{
+  if (lcdCaptureOn)
+    _captureData(data);
+  enqueue(data);
+}
+
+/** Wait until every queued byte has been shifted out */
+void
+_flush()
+{
+  while (txqHead != txqTail)
+    txqWait();
+  while (UCB0STAT & UCBUSY);	/**< wait for last byte to leave the shifter */
+}
+
+/** Write a run of identical byte pairs
+ *
+ *  Short runs are queued like any other data.  Long runs drain the
+ *  queue and then feed TXBUF directly as soon as it empties, so the
+ *  USCI's double buffer is kept full.
+ */
+void _writeDataRun(u_char hi, u_char lo, u_int count)
+{
+  if (lcdCaptureOn)
+    _captureRun(hi, lo, count);
+  if (count < LCD_RUN_DIRECT) {
+    while (count--) {
+      enqueue(hi);
+      enqueue(lo);
+    }
+    return;
+  }
+  while (txqHead != txqTail)	/**< preserve byte order */
+    txqWait();
+  while (count--) {
+    while (!(IFG2 & UCB0TXIFG));
+    UCB0TXBUF = hi;
+    while (!(IFG2 & UCB0TXIFG));
+    UCB0TXBUF = lo;
+  }
+}
+
+/** Write a run of identical byte triples (see _writeDataRun) */
+void _writeDataRun3(u_char b0, u_char b1, u_char b2, u_int count)
+{
+  if (lcdCaptureOn)
+    _captureRun3(b0, b1, b2, count);
+  if (count < LCD_RUN_DIRECT) {
+    while (count--) {
+      enqueue(b0);
+      enqueue(b1);
+      enqueue(b2);
+    }
+    return;
+  }
+  while (txqHead != txqTail)	/**< preserve byte order */
+    txqWait();
+  while (count--) {
+    while (!(IFG2 & UCB0TXIFG));
+    UCB0TXBUF = b0;
+    while (!(IFG2 & UCB0TXIFG));
+    UCB0TXBUF = b1;
+    while (!(IFG2 & UCB0TXIFG));
+    UCB0TXBUF = b2;
+  }
+}
+
+/** Write command to LCD 
+ *
+ *  Drains the transmit queue first: D/C is sampled with the last bit
+ *  of each byte, so it may only change while the bus is idle.
+ */
+void _writeCommand(u_char command) 
+{
+  if (lcdCaptureOn)
+    _captureCommand(command);
+  _flush();
+  LCD_DC_LO();			/**< specify sending a command */
+  UCB0TXBUF = command;		/**< send command */
+  while (UCB0STAT & UCBUSY);	/**< wait for command to complete */
+  LCD_DC_HI();			/**< queued bytes are data */
+}
+
+/** Long delay */
+void _delay(u_char x10ms) {
+	while (x10ms > 0) {
+		__delay_cycles(160000);
+		x10ms--;
+	}
+}
+
+/** Interrupt-timed delays
+ *
+ *  Timer1_A counts SMCLK/8 (2 MHz / 8 with configureClocks) in up
+ *  mode and interrupts every 10 ms; the CPU may sleep in between.
+ *  The period is reloaded every tick so that a clock profile switch
+ *  (clockSetProfile) during a delay only affects the tick in progress.
+ */
+#define DELAY_TICKS_10MS (clockSmclkMHz() * 1250u)
+
+static volatile u_char delayLeft;
+static void (*delayDone)();
+
+void _startDelay(u_char x10ms, void (*done)())
+{
+  if (!x10ms) {
+    done();
+    return;
+  }
+  delayLeft = x10ms;
+  delayDone = done;
+  TA1CCR0 = DELAY_TICKS_10MS - 1;
+  TA1CCTL0 = CCIE;
+  TA1CTL = TASSEL_2 | ID_3 | MC_1 | TACLR;
+}
+
+/** Timer1_A CCR0: count down 10 ms ticks, then run the delay's handler */
+void
+__interrupt_vec(TIMER1_A0_VECTOR) lcd_delayInterrupt()
+{
+  if (--delayLeft) {
+    TA1CCR0 = DELAY_TICKS_10MS - 1;
+    return;
+  }
+  TA1CTL = MC_0;		/**< stop the timer */
+  TA1CCTL0 = 0;
+  delayDone();			/**< may start the next delay */
+  __bic_SR_register_on_exit(CPUOFF); /**< wake _sleepUntil */
+}
+
+/** Sleep until *flag is set
+ *
+ *  Interrupts are disabled while the flag is tested so that a wake-up
+ *  cannot slip in between the test and the sleep.
+ */
+void _sleepUntil(volatile u_char *flag)
+{
+  __disable_interrupt();
+  while (!*flag) {
+    __bis_SR_register(CPUOFF | GIE);
+    __disable_interrupt();
+  }
+  __enable_interrupt();
+}
+
+/** Capture timestamps: Timer1_A counting SMCLK/8 continuously
+ *
+ *  4 us ticks with CLOCK_SLOW; faster profiles count faster.  Not
+ *  while a delay is counting down on the same timer.
+ */
+int _captureClockStart()
+{
+  if (delayLeft)
+    return 0;
+  TA1CTL = TASSEL_2 | ID_3 | MC_2 | TACLR;
+  return 1;
+}
+
+u_int _captureClock()
+{
+  return TA1R;
+}
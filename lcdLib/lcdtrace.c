@@ -0,0 +1,268 @@
+///////////////////////////////////////////
+// Report where the bytes of an LCD command-stream capture went
+// (see lcdcapture.h for the capture format).
+//
+// usage: lcdtrace [-n windows] capture
+//
+// The capture is replayed through the ST7735 emulator (lcdsim.c).
+// For each frame it prints the bytes spent on window setup
+// (CASET, PASET and RAMWR with their parameters), on pixels and on
+// other commands, the pixels written, how many of them already had
+// the color written (overdraw), the time between the frame's first
+// and last commands if timestamped, and the windows that rewrote the
+// most unchanged pixels.  Times assume CLOCK_SLOW's 4 us ticks;
+// divide them by 4 for captures made at CLOCK_FAST, by 8 at CLOCK_MAX.
+///////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "_lcdbus.h"
+#include "lcdsim.h"
+
+#define MAX_WORST 16
+
+typedef struct {
+  u_int colStart, rowStart, colEnd, rowEnd;
+  unsigned long pixels, unchanged;
+} Window;
+
+typedef struct {
+  unsigned long windowBytes, pixelBytes, otherBytes;
+  unsigned long pixels, unchanged, windows;
+  unsigned long ticks;
+  Window worst[MAX_WORST];	/**< most unchanged pixels first */
+} Frame;
+
+static int nWorst = 5;
+static Frame fr, total;
+static int frameNo;
+static u_char command;		/**< last command */
+static int windowOpen;
+static Window win;
+static int haveTime;		/**< capture is timestamped */
+static int frameTimed;		/**< lastTime was set in this frame */
+static u_int lastTime;
+
+/** Keep w if it is among the nWorst most redundant windows of f */
+static void
+rankWindow(Frame *f, const Window *w)
+{
+  int i, j;
+  if (!w->unchanged)
+    return;
+  for (i = 0; i < nWorst; i++)
+    if (w->unchanged > f->worst[i].unchanged)
+      break;
+  if (i == nWorst)
+    return;
+  for (j = nWorst - 1; j > i; j--)
+    f->worst[j] = f->worst[j-1];
+  f->worst[i] = *w;
+}
+
+/** Close the window opened by the last RAMWR */
+static void
+endWindow()
+{
+  if (!windowOpen)
+    return;
+  windowOpen = 0;
+  win.pixels = lcdsimStats.pixels - win.pixels;
+  win.unchanged = lcdsimStats.unchanged - win.unchanged;
+  fr.windows++;
+  rankWindow(&fr, &win);
+  rankWindow(&total, &win);
+}
+
+static void
+printWorst(const Frame *f)
+{
+  int i;
+  for (i = 0; i < nWorst && f->worst[i].unchanged; i++) {
+    const Window *w = &f->worst[i];
+    printf("    (%u,%u)-(%u,%u): %lu of %lu pixels unchanged\n",
+	   w->colStart, w->rowStart, w->colEnd, w->rowEnd,
+	   w->unchanged, w->pixels);
+  }
+}
+
+static void
+printFrame(const char *name, const Frame *f)
+{
+  unsigned long bytes = f->windowBytes + f->pixelBytes + f->otherBytes;
+  printf("%s: %lu bytes (window setup %lu, pixels %lu, other %lu), "
+	 "%lu windows, %lu pixels, %lu unchanged (%lu%%)",
+	 name, bytes, f->windowBytes, f->pixelBytes, f->otherBytes,
+	 f->windows, f->pixels, f->unchanged,
+	 f->pixels ? f->unchanged * 100 / f->pixels : 0);
+  if (haveTime)
+    printf(", %lu.%02lu ms", f->ticks * 4 / 1000, f->ticks * 4 % 1000 / 10);
+  printf("\n");
+  printWorst(f);
+}
+
+static void
+endFrame()
+{
+  char name[32];
+  endWindow();
+  fr.pixels = lcdsimStats.pixels;
+  fr.unchanged = lcdsimStats.unchanged;
+  if (fr.windowBytes + fr.pixelBytes + fr.otherBytes) {
+    snprintf(name, sizeof(name), "frame %d", frameNo++);
+    printFrame(name, &fr);
+    total.windowBytes += fr.windowBytes;
+    total.pixelBytes += fr.pixelBytes;
+    total.otherBytes += fr.otherBytes;
+    total.pixels += fr.pixels;
+    total.unchanged += fr.unchanged;
+    total.windows += fr.windows;
+    total.ticks += fr.ticks;
+  }
+  memset(&fr, 0, sizeof(fr));
+  lcdsim_resetStats();
+  frameTimed = 0;
+}
+
+static int
+isWindowCommand(u_char c)
+{
+  return c == CASETP || c == PASETP || c == RAMWRP;
+}
+
+/** Count n data bytes sent after the current command */
+static void
+countData(unsigned long n)
+{
+  if (command == RAMWRP)
+    fr.pixelBytes += n;
+  else if (isWindowCommand(command))
+    fr.windowBytes += n;
+  else
+    fr.otherBytes += n;
+}
+
+static void
+doCommand(u_char c, int timed, u_int time)
+{
+  endWindow();
+  command = c;
+  if (isWindowCommand(c))
+    fr.windowBytes++;
+  else
+    fr.otherBytes++;
+  if (timed) {
+    if (frameTimed)
+      fr.ticks += (time - lastTime) & 0xffff;
+    haveTime = frameTimed = 1;
+    lastTime = time;
+  }
+  _writeCommand(c);
+  if (c == RAMWRP) {
+    windowOpen = 1;
+    lcdsim_getWindow(&win.colStart, &win.rowStart, &win.colEnd, &win.rowEnd);
+    win.pixels = lcdsimStats.pixels;
+    win.unchanged = lcdsimStats.unchanged;
+  }
+}
+
+static void
+usage()
+{
+  fprintf(stderr, "usage: lcdtrace [-n windows] capture\n");
+  exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+  FILE *fp;
+  u_char *buf, *p, *end;
+  long size;
+  int timed;
+
+  if (argc == 4 && !strcmp(argv[1], "-n")) {
+    nWorst = atoi(argv[2]);
+    if (nWorst < 0 || nWorst > MAX_WORST)
+      nWorst = MAX_WORST;
+    argv += 2;
+    argc -= 2;
+  }
+  if (argc != 2)
+    usage();
+  if (!(fp = fopen(argv[1], "rb"))) {
+    perror(argv[1]);
+    return 1;
+  }
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  rewind(fp);
+  buf = malloc(size ? size : 1);
+  if (!buf || fread(buf, 1, size, fp) != (size_t)size) {
+    fprintf(stderr, "%s: read failed\n", argv[1]);
+    return 1;
+  }
+  fclose(fp);
+  if (size < 4 || buf[0] != 'L' || buf[1] != 'T' || buf[2] != 1) {
+    fprintf(stderr, "%s: not an lcdcapture file\n", argv[1]);
+    return 1;
+  }
+  timed = buf[3] & 1;
+
+  _setUpBus();
+  lcdsim_resetStats();
+  for (p = buf + 4, end = buf + size; p < end; ) {
+    u_char n;
+    u_int count;
+    switch (*p) {
+    case 'C':
+      if (p + (timed ? 4 : 2) > end)
+	goto truncated;
+      doCommand(p[1], timed, timed ? p[2] | (p[3] << 8) : 0);
+      p += timed ? 4 : 2;
+      break;
+    case 'D':
+      if (p + 2 > end || p + 2 + p[1] > end)
+	goto truncated;
+      for (n = 0; n < p[1]; n++)
+	_writeData(p[2 + n]);
+      countData(p[1]);
+      p += 2 + p[1];
+      break;
+    case 'R':
+      if (p + 5 > end)
+	goto truncated;
+      count = p[3] | (p[4] << 8);
+      _writeDataRun(p[1], p[2], count);
+      countData(2ul * count);
+      p += 5;
+      break;
+    case 'T':
+      if (p + 6 > end)
+	goto truncated;
+      count = p[4] | (p[5] << 8);
+      _writeDataRun3(p[1], p[2], p[3], count);
+      countData(3ul * count);
+      p += 6;
+      break;
+    case 'F':
+      endFrame();
+      p++;
+      break;
+    default:
+      fprintf(stderr, "%s: bad record 0x%02x at offset %ld\n",
+	      argv[1], *p, (long)(p - buf));
+      return 1;
+    }
+  }
+  endFrame();
+  printFrame("total", &total);
+  return 0;
+
+ truncated:
+  fprintf(stderr, "%s: truncated record at offset %ld\n", argv[1], (long)(p - buf));
+  endFrame();
+  printFrame("total", &total);
+  return 1;
+}
@@ -3,88 +3,70 @@
  *  \brief Created on: 10/19/2016
  *  Author: Eric Freudenthal & David Pruitt
  *  Derived from EduKit code by RobG
- *  Chip select: P1.0
- *  Data/Cmd: P1.4
- *  Buzzer: P2.6 (default)
+ *
+ *  Bytes reach the controller through _lcdbus.h: lcdspi.c on the
+ *  msp430, lcdsim.c on the host.
  */
  
 #include "lcdutils.h"
-#include "msp430.h"
+#include "_lcdbus.h"
 
 u_char _orientation = 0;
 
-/** LCD pin definitions*/
-/** SCLK & MOSI*/
-#define LCD_SPI_OUT		P1OUT
-#define LCD_SPI_DIR		P1DIR
-#define LCD_SPI_SEL		P1SEL
-#define LCD_SPI_SEL2	P1SEL2
-#define LCD_SCLK_PIN	BIT5
-#define LCD_MOSI_PIN	BIT7
-
-/** Chip select */
-#define LCD_CS_PIN	BIT0
-#define LCD_CS_DIR	P1DIR
-#define LCD_CS_OUT	P1OUT
-
-/** CS convenience defines */
-#define LCD_SELECT() LCD_CS_OUT &= ~LCD_CS_PIN
-#define LCD_DESELECT()
-
-/** Data/command */
-#define LCD_DC_PIN	BIT4
-#define LCD_DC_DIR	P1DIR
-#define LCD_DC_OUT	P1OUT
-
-/** D/C convenience defines */
-#define LCD_DC_LO() LCD_DC_OUT &= ~LCD_DC_PIN
-#define LCD_DC_HI() LCD_DC_OUT |= LCD_DC_PIN
-
-/** LCD driver IC specific defines */
-#define SWRESET							0x01
-#define	SLEEPOUT						0x11
-#define DISPON							0x29
-#define CASETP							0x2A
-#define PASETP							0x2B
-#define RAMWRP							0x2C
-#define	MADCTL							0x36
-#define	COLMOD							0x3A
-#define GMCTRP1							0xE0
-#define GMCTRN1							0xE1
-
-/** Set up onboard LCD's SPI and control pins */
-static void setUpSPIforLCD() {
-  LCD_DC_OUT |= LCD_DC_PIN;
-  LCD_DC_DIR |= LCD_DC_PIN;
-  
-  LCD_CS_OUT |= LCD_CS_PIN;
-  LCD_CS_DIR |= LCD_CS_PIN;
-  
-  LCD_SPI_OUT |= LCD_SCLK_PIN;
-  LCD_SPI_DIR |= LCD_SCLK_PIN;
-  LCD_SPI_OUT |= LCD_MOSI_PIN;
-  LCD_SPI_DIR |= LCD_MOSI_PIN;
-  LCD_SPI_SEL |= LCD_SCLK_PIN + LCD_MOSI_PIN;
-  LCD_SPI_SEL2 |= LCD_SCLK_PIN + LCD_MOSI_PIN;
-  
-  UCB0CTL1 |= UCSWRST;
-  UCB0CTL0 = UCCKPH + UCMSB + UCMST + UCSYNC; /**< 3-pin, 8-bit SPI master */
-  UCB0CTL1 |= UCSSEL_2; /**< SMCLK */
-  UCB0BR0 |= 0x01; /**< 1:1 */
-  UCB0BR1 = 0;
-  UCB0CTL1 &= ~UCSWRST;
-  LCD_SELECT();
-}
-
-/** Screen dimensions */
-
-/** Write data to LCD */
-static inline void 
-lcd_writeData(u_char data) 
-{
-  while (UCB0STAT & UCBUSY);	/**< wait for previous transfer to complete */
-  LCD_DC_HI();			/**< specify sending data */
-  UCB0TXBUF = data;		/**< send data */
+/** Controller state as last set by lcd_setArea
+ *
+ *  Lets lcd_setArea skip CASET or PASET when they would not change
+ *  the window, and skip all three commands when the requested area
+ *  continues the open RAMWR stream.
+ */
+static struct {
+  u_int colStart, colEnd, rowStart, rowEnd;
+  u_char valid;			/**< window fields match the controller */
+  u_char streaming;		/**< no command since RAMWR */
+  u_int written;		/**< pixels written since RAMWR */
+  u_int size;			/**< pixels in the window, 0 if too many to count */
+  u_int segEnd;			/**< value of written at the end of the area */
+  u_int nextRow, lastRow;	/**< rows of lcd_setArea's area still to open */
+  u_char moreRows;		/**< area continues at nextRow */
+} win;
+
+/** Vertical scrolling band (see lcd_scrollDefine); height 0 when off */
+static struct {
+  u_int top, height, offset;
+} scroll;
+
+/** Pixel format (COLMOD value) and, in 12-bit mode, a pixel that is
+ *  waiting for a partner: two 12-bit pixels are sent as three bytes.
+ */
+static u_char colorMode = LCD_COLOR_16BIT;
+static u_char pairPending;
+static u_int pairColor;		/**< 4-4-4 color of the pending pixel */
+
+/** Send a pending 12-bit pixel on its own (private)
+ *
+ *  Its two bytes carry 4 padding bits that the controller discards
+ *  at the next command, so the write stream must not continue.
+ */
+static void
+endPixelPair()
+{
+  if (pairPending) {
+    _writeData(pairColor >> 4);
+    _writeData(pairColor << 4);
+    pairPending = 0;
+    win.streaming = 0;
+  }
+}
+
+LcdWindowStats lcdWindowStats;
+
+/** Write a command that is not part of an address window (private) */
+static void
+writeCommand(u_char command)
+{
+  endPixelPair();
+  win.streaming = 0;
+  _writeCommand(command);
 }
 
 typedef union {
@@ -92,70 +74,365 @@ typedef union {
   u_int colorBGRWord;
 } ColorBGR;
 
+/** Queue one pixel in 12-bit mode (private) */
+static void
+writeColor12(u_int colorBGR)
+{
+  u_int c = bgr2color12(colorBGR);
+  if (pairPending) {
+    _writeData(pairColor >> 4);
+    _writeData((pairColor << 4) | (c >> 8));
+    _writeData(c);
+    pairPending = 0;
+  } else {
+    pairColor = c;
+    pairPending = 1;
+    if (win.written + 1 == win.size) /* last pixel of the window */
+      endPixelPair();
+  }
+}
+
+static void nextSegment();
+
 void lcd_writeColor(u_int colorBGR)
 {
-  ColorBGR colorU = {.colorBGRWord = colorBGR};
-  lcd_writeData(colorU.colorBytes[1]);
-  lcd_writeData(colorU.colorBytes[0]);
+  if (win.moreRows && win.written == win.segEnd)
+    nextSegment();
+  if (colorMode == LCD_COLOR_12BIT)
+    writeColor12(colorBGR);
+  else {
+    ColorBGR colorU = {.colorBGRWord = colorBGR};
+    _writeDataRun(colorU.colorBytes[1], colorU.colorBytes[0], 1);
+  }
+  win.written++;
+}
+
+/** Write a run of identical pixels within one window (private)
+ *
+ *  In 12-bit mode the run is completed pairwise: a pending pixel
+ *  takes the first pixel of the run, pairs of pixels become a
+ *  repeating 3-byte pattern, and an odd last pixel is left pending.
+ */
+static void
+writeRun(u_int colorBGR, u_int count)
+{
+  if (colorMode == LCD_COLOR_12BIT) {
+    u_int c = bgr2color12(colorBGR);
+    u_int end = win.written + count;
+    if (count && pairPending) {
+      writeColor12(colorBGR);
+      count--;
+    }
+    _writeDataRun3(c >> 4, (c << 4) | (c >> 8), c, count >> 1);
+    if (count & 1) {
+      pairColor = c;
+      pairPending = 1;
+      if (end == win.size)
+	endPixelPair();
+    }
+    win.written = end;
+  } else {
+    _writeDataRun(colorBGR >> 8, colorBGR, count);
+    win.written += count;
+  }
+}
+
+/** Write a run of identical pixels, opening the next window of a
+ *  scrolled area whenever the current one fills up */
+void lcd_writeColorRun(u_int colorBGR, u_int count)
+{
+  while (win.moreRows && win.written + count > win.segEnd) {
+    u_int n = win.segEnd - win.written;
+    writeRun(colorBGR, n);
+    count -= n;
+    nextSegment();
+  }
+  writeRun(colorBGR, count);
 }
 
-/** Write command to LCD (private) */
-void _writeCommand(u_char command) 
+void lcd_setColorMode(u_char mode)
 {
-  while (UCB0STAT & UCBUSY);	/**< wait for previous transfer to complete */
-  LCD_DC_LO();			          /**< specify sending a command */
-  UCB0TXBUF = command;		    /**< send command */
+  writeCommand(COLMOD);
+  _writeData(mode);
+  colorMode = mode;
 }
 
-/** Long delay (private) */
-void _delay(u_char x10ms) {
-	while (x10ms > 0) {
-		__delay_cycles(160000);
-		x10ms--;
-	}
+/** Send pending pixels, then wait for the transmit queue to drain */
+void lcd_flush()
+{
+  endPixelPair();
+  _flush();
+}
+
+/** Send the controller's address window (private)
+ *
+ *  Rows are physical (already mapped by lcd_scrollRow).
+ */
+static void
+setWindow(u_int colStart, u_int rowStart, u_int colEnd, u_int rowEnd) 
+{
+  u_char sameCols = win.valid && colStart == win.colStart && colEnd == win.colEnd;
+  u_char sameRows = win.valid && rowStart == win.rowStart && rowEnd == win.rowEnd;
+  unsigned long size = (unsigned long)(colEnd - colStart + 1) * (rowEnd - rowStart + 1);
+
+  /* continue the RAMWR stream if its write pointer is at (colStart, rowStart) */
+  if (sameCols && win.streaming && win.size
+      && rowStart >= win.rowStart && rowEnd <= win.rowEnd
+      && win.written == (u_int)(rowStart - win.rowStart) * (colEnd - colStart + 1)) {
+    lcdWindowStats.bytesSaved += 11;
+    win.segEnd = win.written + (u_int)(colEnd - colStart + 1) * (rowEnd - rowStart + 1);
+    return;
+  }
+  endPixelPair();
+  if (sameCols)
+    lcdWindowStats.bytesSaved += 5;
+  else {
+    _writeCommand(CASETP);
+    _writeData(colStart >> 8);
+    _writeData(colStart);
+    _writeData(colEnd >> 8);
+    _writeData(colEnd);
+    lcdWindowStats.bytesSent += 5;
+  }
+  if (sameRows)
+    lcdWindowStats.bytesSaved += 5;
+  else {
+    _writeCommand(PASETP);
+    _writeData(rowStart >> 8);
+    _writeData(rowStart);
+    _writeData(rowEnd >> 8);
+    _writeData(rowEnd);
+    lcdWindowStats.bytesSent += 5;
+  }
+  _writeCommand(RAMWRP);
+  lcdWindowStats.bytesSent++;
+  win.colStart = colStart;
+  win.colEnd = colEnd;
+  win.rowStart = rowStart;
+  win.rowEnd = rowEnd;
+  win.valid = win.streaming = 1;
+  win.written = 0;
+  win.size = win.segEnd = size > 0xffff ? 0 : size;
+}
+
+/** Last row, starting at row, whose physical rows are consecutive (private) */
+static u_int
+segmentEnd(u_int row, u_int rowEnd)
+{
+  u_int bandEnd = scroll.top + scroll.height - 1;
+  u_int end;
+  if (!scroll.height || row > bandEnd)
+    return rowEnd;
+  if (row < scroll.top)
+    end = scroll.top - 1;
+  else {			/* up to the wrap or the end of the band */
+    end = row + (bandEnd - lcd_scrollRow(row));
+    if (end > bandEnd)
+      end = bandEnd;
+  }
+  return end < rowEnd ? end : rowEnd;
+}
+
+/** Open the window for the next rows of a scrolled area (private) */
+static void
+nextSegment()
+{
+  u_int rowStart = win.nextRow, rowEnd = segmentEnd(rowStart, win.lastRow);
+  setWindow(win.colStart, lcd_scrollRow(rowStart), win.colEnd, lcd_scrollRow(rowEnd));
+  win.nextRow = rowEnd + 1;
+  win.moreRows = rowEnd < win.lastRow;
+}
+
+/** Set area to draw to, in 16-bit coordinates
+ *
+ *  While a scrolling band is defined, rows are logical: an area that
+ *  wraps around the band is written as several controller windows,
+ *  opened as the pixels arrive.
+ */
+void lcd_setArea16(u_int colStart, u_int rowStart, u_int colEnd, u_int rowEnd) 
+{
+  u_int segEnd;
+  if (!scroll.height) {
+    setWindow(colStart, rowStart, colEnd, rowEnd);
+    win.moreRows = 0;
+    return;
+  }
+  segEnd = segmentEnd(rowStart, rowEnd);
+  setWindow(colStart, lcd_scrollRow(rowStart), colEnd, lcd_scrollRow(segEnd));
+  win.nextRow = segEnd + 1;
+  win.lastRow = rowEnd;
+  win.moreRows = segEnd < rowEnd;
 }
 
 /** Set area to draw to */
 void lcd_setArea(u_char colStart, u_char rowStart, u_char colEnd, u_char rowEnd) 
 {
-	_writeCommand(CASETP);
-	lcd_writeData(0);
-	lcd_writeData(colStart);
-	lcd_writeData(0);
-	lcd_writeData(colEnd);
-	_writeCommand(PASETP);
-	lcd_writeData(0);
-	lcd_writeData(rowStart);
-	lcd_writeData(0);
-	lcd_writeData(rowEnd);
-	_writeCommand(RAMWRP);
+  lcd_setArea16(colStart, rowStart, colEnd, rowEnd);
 }
 
-/** Initialize onboard LCD */
-void lcd_init() 
+/** Vertical scrolling
+ *
+ *  The controller scrolls along the panel's long edge, so scrolling
+ *  moves screen rows only in the vertical orientations.  VSCRDEF and
+ *  VSCRSADD count display lines from the top of the panel, which is
+ *  the bottom of the screen when MADCTL's MY bit is set.
+ */
+#if (ORIENTATION == ORIENTATION_VERTICAL) || (ORIENTATION == ORIENTATION_VERTICAL_ROTATED)
+# define SCROLL_SUPPORTED 1
+#else
+# define SCROLL_SUPPORTED 0
+#endif
+#define SCROLL_FLIPPED (ORIENTATION == ORIENTATION_VERTICAL) /**< MY set */
+
+static void
+writeWord(u_int w)
 {
-  setUpSPIforLCD();
-  _writeCommand(SWRESET);  /**< software reset */
-  _delay(20);
-  _writeCommand(SLEEPOUT); /**< exit sleep */
-  _delay(20);
-  _writeCommand(COLMOD);   /**< Set Color Format 16bit */
-  lcd_writeData(0x05);
-  _writeCommand(DISPON);   /**< display ON */
+  _writeData(w >> 8);
+  _writeData(w);
+}
 
-  _writeCommand(MADCTL);
+void lcd_scrollDefine(u_int topFixed, u_int bottomFixed)
+{
+  if (!SCROLL_SUPPORTED)
+    return;
+  if (topFixed >= screenHeight || bottomFixed >= screenHeight - topFixed) {
+    lcd_scrollOff();		/* no rows left to scroll */
+    return;
+  }
+  scroll.top = topFixed;
+  scroll.height = screenHeight - topFixed - bottomFixed;
+  writeCommand(VSCRDEF);
+  writeWord(SCROLL_FLIPPED ? bottomFixed : topFixed);
+  writeWord(scroll.height);
+  writeWord(SCROLL_FLIPPED ? topFixed : bottomFixed);
+  lcd_scrollTo(0);
+}
+
+void lcd_scrollTo(u_int offset)
+{
+  u_int first;
+  if (!scroll.height)
+    return;
+  scroll.offset = offset % scroll.height;
+  if (SCROLL_FLIPPED)		/* display lines run bottom to top */
+    first = screenHeight - scroll.top - scroll.height
+      + (scroll.height - scroll.offset) % scroll.height;
+  else
+    first = scroll.top + scroll.offset;
+  writeCommand(VSCRSADD);
+  writeWord(first);
+}
+
+void lcd_scrollOff()
+{
+  if (!scroll.height)
+    return;
+  scroll.height = 0;
+  writeCommand(NORON);		/**< normal display mode ends scrolling */
+}
+
+u_int lcd_scrollRow(u_int row)
+{
+  u_int rel = row - scroll.top;
+  if (!scroll.height || row < scroll.top || rel >= scroll.height)
+    return row;
+  rel += scroll.offset;
+  if (rel >= scroll.height)
+    rel -= scroll.height;
+  return scroll.top + rel;
+}
+
+/** Set a single-row area and fill count pixels of it */
+void lcd_writeRowSpan(u_int colStart, u_int row, u_int count, u_int colorBGR)
+{
+  if (!count)
+    return;
+  lcd_setArea16(colStart, row, colStart + count - 1, row);
+  lcd_writeColorRun(colorBGR, count);
+}
+
+/** Initialization steps around the two 200 ms delays (private) */
+static void
+initReset()
+{
+  _setUpBus();
+  win.valid = 0;		/**< controller window unknown */
+  scroll.height = 0;
+  writeCommand(SWRESET);  /**< software reset */
+}
+
+static void
+initWake()
+{
+  writeCommand(SLEEPOUT); /**< exit sleep */
+}
+
+static void
+initFinish()
+{
+  lcd_setColorMode(colorMode); /**< 16 bit unless lcd_setColorMode was called */
+  writeCommand(DISPON);   /**< display ON */
+
+  writeCommand(MADCTL);
   switch (ORIENTATION) {
   case ORIENTATION_HORIZONTAL:
-    lcd_writeData(0x68);
+    _writeData(0x68);
     break;
   case ORIENTATION_VERTICAL_ROTATED:
-    lcd_writeData(0x08);
+    _writeData(0x08);
     break;
   case ORIENTATION_HORIZONTAL_ROTATED:
-    lcd_writeData(0xA8);
+    _writeData(0xA8);
+    break;
+  default:
+    _writeData(0xC8);
+  }
+}
+
+/** Initialize onboard LCD */
+void lcd_init() 
+{
+  initReset();
+  _delay(20);
+  initWake();
+  _delay(20);
+  initFinish();
+  lcdReady = 1;
+}
+
+volatile u_char lcdReady;
+static void (*readyHandler)();
+static u_char initStep;
+
+/** Run the step that follows an elapsed delay (called from the
+ *  transport's timer interrupt)
+ */
+static void
+initAdvance()
+{
+  switch (initStep++) {
+  case 0:
+    initWake();
+    _startDelay(20, initAdvance);
     break;
   default:
-    lcd_writeData(0xC8);
+    initFinish();
+    lcdReady = 1;
+    if (readyHandler)
+      readyHandler();
   }
 }
 
+void lcd_initAsync(void (*onReady)())
+{
+  lcdReady = 0;
+  readyHandler = onReady;
+  initStep = 0;
+  initReset();
+  _startDelay(20, initAdvance);
+}
+
+void lcd_waitReady()
+{
+  _sleepUntil(&lcdReady);
+}
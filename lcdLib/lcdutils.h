@@ -18,8 +18,12 @@ extern const unsigned int colors[43];
 
 
 /** Orientation */
+#ifndef LONG_EDGE_PIXELS		/**< e.g. -DLONG_EDGE_PIXELS=320 for a 240x320 panel */
 #define LONG_EDGE_PIXELS				160
+#endif
+#ifndef SHORT_EDGE_PIXELS		/**< e.g. -DSHORT_EDGE_PIXELS=240 */
 #define SHORT_EDGE_PIXELS				128
+#endif
 #define ORIENTATION_VERTICAL			0
 #define ORIENTATION_HORIZONTAL			1
 #define ORIENTATION_VERTICAL_ROTATED	2
@@ -38,9 +42,28 @@ extern const unsigned int colors[43];
 # define screenWidth LONG_EDGE_PIXELS
 #endif
 
-/** Initialize the onboard LCD */
+/** Initialize the onboard LCD (blocks for about 400 ms) */
 void lcd_init();
 
+/** Start initializing the onboard LCD and return at once
+ *
+ *  The reset and wake-up delays are timed by Timer1_A, whose
+ *  interrupt sends the next commands, so the CPU can set up other
+ *  devices and compute the first frame meanwhile.  Interrupts must be
+ *  enabled (or_sr(0x8)) for initialization to progress.  Nothing may
+ *  be drawn until lcdReady is set.
+ *
+ *  \param onReady Called (from the timer interrupt) when the display
+ *  is ready, or 0
+ */
+void lcd_initAsync(void (*onReady)());
+
+/** Set when lcd_init or lcd_initAsync has finished */
+extern volatile u_char lcdReady;
+
+/** Sleep in LPM0 until lcdReady is set */
+void lcd_waitReady();
+
 /** Set area to draw to
  *  
  *  \param colStart Start column of the area
@@ -50,12 +73,154 @@ void lcd_init();
  */
 void lcd_setArea(u_char colStart, u_char rowStart, u_char colEnd, u_char rowEnd);
 
+/** Set area to draw to, in 16-bit coordinates
+ *
+ *  As lcd_setArea, for panels with more than 256 rows or columns:
+ *  CASET and PASET carry the coordinates' high bytes.  The area must
+ *  be on the screen; the ...16 functions in lcddraw.h clip.  Windows
+ *  of more than 65535 pixels are written, but not continued by later
+ *  lcd_setArea calls.
+ */
+void lcd_setArea16(u_int colStart, u_int rowStart, u_int colEnd, u_int rowEnd);
+
+/** Command bytes lcd_setArea sent and avoided
+ *
+ *  A full CASET+PASET+RAMWR sequence is 11 bytes.  lcd_setArea omits
+ *  CASET or PASET when they are unchanged and omits everything when
+ *  the area continues the current write stream.
+ */
+typedef struct {
+  unsigned long bytesSent, bytesSaved;
+} LcdWindowStats;
+
+extern LcdWindowStats lcdWindowStats;
+
 /** Write color to LCD
  *
  *  \param colorBGR The color in BGR
  */
 void lcd_writeColor(u_int colorBGR);
 
+/** Write count pixels of the same color
+ *
+ *  Much faster than calling lcd_writeColor count times.
+ *
+ *  \param colorBGR The color in BGR
+ *  \param count Number of pixels
+ */
+void lcd_writeColorRun(u_int colorBGR, u_int count);
+
+/** Fill a horizontal span of a single row
+ *
+ *  \param colStart First column of the span
+ *  \param row Row of the span
+ *  \param count Width of the span in pixels (nothing is drawn if 0)
+ *  \param colorBGR The color in BGR
+ */
+void lcd_writeRowSpan(u_int colStart, u_int row, u_int count, u_int colorBGR);
+
+/** Run accumulator for renderers that compute one pixel at a time.
+ *  
+ *  Consecutive pixels of the same color are merged and sent with
+ *  lcd_writeColorRun.  Initialize count to 0.
+ */
+typedef struct {
+  u_int color, count;
+} LcdRun;
+
+/** Append one pixel to run, writing out the previous run if the color changed */
+static inline void
+lcd_runAdd(LcdRun *run, u_int colorBGR)
+{
+  if (run->count && run->color != colorBGR) {
+    lcd_writeColorRun(run->color, run->count);
+    run->count = 0;
+  }
+  run->color = colorBGR;
+  run->count++;
+}
+
+/** Append count pixels of one color to run */
+static inline void
+lcd_runAddCount(LcdRun *run, u_int colorBGR, u_int count)
+{
+  if (!count)
+    return;
+  if (run->count && run->color != colorBGR) {
+    lcd_writeColorRun(run->color, run->count);
+    run->count = 0;
+  }
+  run->color = colorBGR;
+  run->count += count;
+}
+
+/** Write out any pending pixels of run */
+static inline void
+lcd_runFlush(LcdRun *run)
+{
+  if (run->count)
+    lcd_writeColorRun(run->color, run->count);
+  run->count = 0;
+}
+
+/** Define a hardware scrolling band
+ *
+ *  The rows between topFixed rows at the top of the screen and
+ *  bottomFixed rows at the bottom scroll as a ring; the fixed rows
+ *  (e.g. a score bar) stay put.  While the band is defined,
+ *  lcd_setArea takes logical rows (as shown on screen) and maps them
+ *  through lcd_scrollRow, so the drawing functions keep working.
+ *  Only the vertical orientations can scroll rows; elsewhere this
+ *  does nothing.  If the fixed rows leave no row to scroll, this
+ *  turns scrolling off (lcd_scrollOff).
+ *
+ *  \param topFixed Number of fixed rows at the top
+ *  \param bottomFixed Number of fixed rows at the bottom
+ */
+void lcd_scrollDefine(u_int topFixed, u_int bottomFixed);
+
+/** Scroll the band so that logical row topFixed shows the row that
+ *  was offset rows below it when the band was defined.  Scrolling by
+ *  one row exposes one logical row at the bottom of the band: only
+ *  that row needs to be redrawn.
+ */
+void lcd_scrollTo(u_int offset);
+
+/** Leave scrolling mode; rows are no longer mapped */
+void lcd_scrollOff();
+
+/** Row address written to show logical row on screen */
+u_int lcd_scrollRow(u_int row);
+
+/** Pixel formats for lcd_setColorMode (COLMOD values) */
+#define LCD_COLOR_16BIT 0x05	/**< 5-6-5, two bytes per pixel (default) */
+#define LCD_COLOR_12BIT 0x03	/**< 4-4-4, three bytes per two pixels */
+
+/** Select the pixel format used on the bus
+ *
+ *  Colors are still passed as 16-bit BGR values; in 12-bit mode the
+ *  low bits of each channel are dropped (see bgr2color12), which
+ *  moves 25% fewer bytes per pixel.
+ *
+ *  \param mode LCD_COLOR_16BIT or LCD_COLOR_12BIT
+ */
+void lcd_setColorMode(u_char mode);
+
+/** Convert a 16-bit BGR color to the 12-bit (4-4-4) bus format */
+#define bgr2color12(c) ((((c) >> 4) & 0xf00) | (((c) >> 3) & 0xf0) | (((c) >> 1) & 0xf))
+
+/** Wait until all pixel data written so far has been sent to the LCD
+ *
+ *  Pixel data is queued and transmitted by the USCI_B0 TX interrupt.
+ *  Commands (e.g. lcd_setArea) flush implicitly; call this before
+ *  reconfiguring the SPI pins or clocks.
+ *
+ *  In 12-bit mode an odd pixel waiting for its partner is sent here,
+ *  so the next pixels need a new lcd_setArea.  Pixels that complete
+ *  their area are always sent without a flush.
+ */
+void lcd_flush();
+
 #define rgb2bgr(val) ((((val) << 11)&0xf800) | ((val)&0x7e0) | (((val)>>11)&0x1f))
 
 /** Colors */
@@ -0,0 +1,141 @@
+///////////////////////////////////////////
+// Pack lcdLib's bitmap fonts into the compact PackedFont format
+// (see lcddraw.h) and optionally keep only a subset of glyphs.
+//
+// usage: makeFont 5x7|8x12|11x16 name [chars] > name.c
+//
+// Each glyph is cropped to the bounding box of its foreground pixels:
+//   byte 0: (x0 << 4) | y0        top-left of the box in the cell
+//   byte 1: ((w-1) << 4) | (h-1)  box size
+//   then w*h bits, row-major, MSB first
+// A blank glyph is the single byte 0xff.
+///////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lcdutils.h"
+
+typedef struct {
+  const char *name;
+  int width, height, gap, rawBytes;
+  int (*pixel)(int c, int col, int row); /* c is the character code */
+} SrcFont;
+
+static int pixel5x7(int c, int col, int row)
+{
+  return (font_5x7[c - 0x20][col] >> row) & 1;
+}
+
+static int pixel8x12(int c, int col, int row)
+{
+  return (font_8x12[c - 0x20][row] >> (7 - col)) & 1;
+}
+
+static int pixel11x16(int c, int col, int row)
+{
+  return (font_11x16[c - 0x20][col] >> row) & 1;
+}
+
+static const SrcFont fonts[] = {
+  {"5x7", 5, 8, 1, 5, pixel5x7},
+  {"8x12", 8, 12, 0, 12, pixel8x12},
+  {"11x16", 11, 16, 1, 22, pixel11x16},
+};
+
+int main(int argc, char **argv)
+{
+  const SrcFont *font = 0;
+  const char *name, *chars;
+  char all[96];
+  int i, c, total = 0, nGlyphs;
+  size_t f;
+
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s 5x7|8x12|11x16 name [chars]\n", argv[0]);
+    return 1;
+  }
+  for (f = 0; f < sizeof(fonts) / sizeof(fonts[0]); f++)
+    if (!strcmp(argv[1], fonts[f].name))
+      font = &fonts[f];
+  if (!font) {
+    fprintf(stderr, "%s: unknown font %s\n", argv[0], argv[1]);
+    return 1;
+  }
+  name = argv[2];
+  for (i = 0; i < 95; i++)	/* 0x20 .. 0x7e */
+    all[i] = 0x20 + i;
+  all[95] = 0;
+  chars = argc > 3 ? argv[3] : all;
+  nGlyphs = strlen(chars);
+  for (i = 0; i < nGlyphs; i++)
+    if (chars[i] < 0x20 || chars[i] > 0x7e) {
+      fprintf(stderr, "%s: character 0x%02x is not in the font\n", argv[0], chars[i]);
+      return 1;
+    }
+
+  printf("// Automatically generated by makeFont %s %s%s\n",
+	 font->name, name, argc > 3 ? " (subset)" : "");
+  printf("#include \"lcdutils.h\"\n#include \"lcddraw.h\"\n\n");
+
+  printf("static const u_char %s_data[] = {\n", name);
+  int offsets[96];
+  for (i = 0; i < nGlyphs; i++) {
+    int x0 = font->width, y0 = font->height, x1 = -1, y1 = -1, col, row;
+    c = chars[i];
+    offsets[i] = total;
+    for (row = 0; row < font->height; row++)
+      for (col = 0; col < font->width; col++)
+	if (font->pixel(c, col, row)) {
+	  if (col < x0) x0 = col;
+	  if (col > x1) x1 = col;
+	  if (row < y0) y0 = row;
+	  if (row > y1) y1 = row;
+	}
+    printf("  /* '%c' */ ", c);
+    if (x1 < 0) {		/* blank */
+      printf("0xff,\n");
+      total++;
+      continue;
+    }
+    int w = x1 - x0 + 1, h = y1 - y0 + 1, nbits = 0, byte = 0;
+    printf("0x%02x, 0x%02x,", (x0 << 4) | y0, ((w - 1) << 4) | (h - 1));
+    total += 2;
+    for (row = y0; row <= y1; row++)
+      for (col = x0; col <= x1; col++) {
+	byte = (byte << 1) | font->pixel(c, col, row);
+	if (++nbits == 8) {
+	  printf(" 0x%02x,", byte);
+	  total++;
+	  nbits = byte = 0;
+	}
+      }
+    if (nbits) {
+      printf(" 0x%02x,", byte << (8 - nbits));
+      total++;
+    }
+    printf("\n");
+  }
+  printf("};\n\n");
+
+  printf("static const u_int %s_offsets[%d] = {", name, nGlyphs);
+  for (i = 0; i < nGlyphs; i++)
+    printf("%s%d,", i % 12 ? " " : "\n  ", offsets[i]);
+  printf("\n};\n\n");
+
+  printf("const PackedFont %s = {\n", name);
+  printf("  %d, %d, %d, %d,\n", font->width, font->height, font->gap, nGlyphs);
+  if (argc > 3) {
+    printf("  \"");
+    for (i = 0; i < nGlyphs; i++)
+      printf(chars[i] == '"' || chars[i] == '\\' ? "\\%c" : "%c", chars[i]);
+    printf("\",\n");
+  } else
+    printf("  0,\t\t\t\t/* every character from 0x20 */\n");
+  printf("  %s_offsets, %s_data\n};\n", name, name);
+
+  fprintf(stderr, "%s: %d glyphs, %d data + %d offset bytes "
+	  "(font_%s table: %d bytes)\n", name, nGlyphs, total, 2 * nGlyphs,
+	  font->name, 95 * font->rawBytes);
+  return 0;
+}
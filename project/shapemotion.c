@@ -12,6 +12,7 @@
 #include <libTimer.h>
 #include <lcdutils.h>
 #include <lcddraw.h>
+#include <lcddriver.h>
 #include <p2switches.h>
 #include <shape.h>
 #include <abCircle.h>
@@ -21,13 +22,14 @@
 
 //initial score for the paddles
 char cScore[7]="CPU:00\0",pScore[6]="P1:00\0";
+TextField cScoreField, pScoreField; /* redraw only changed digits */
 
 //paddle and ball "objects"
-AbRect paddle = {abRectGetBounds, abRectCheck, {20,3}};
-AbRect ball = {abRectGetBounds, abRectCheck, {2,2}};
+AbRect paddle = {abRectGetBounds, abRectCheck, abRectGetSpans, ABSHAPE_RECT, {20,3}};
+AbRect ball = {abRectGetBounds, abRectCheck, abRectGetSpans, ABSHAPE_RECT, {2,2}};
 
 AbRectOutline fieldOutline = {	/* playing field */
-  abRectOutlineGetBounds, abRectOutlineCheck,   
+  abRectOutlineGetBounds, abRectOutlineCheck, abRectOutlineGetSpans, ABSHAPE_RECT_OUTLINE,
   {screenWidth/2 - 1, screenHeight/2 - 5}
 };
   
@@ -80,9 +82,10 @@ MovLayer ml3 = { &layer3, {3,-5}, 0 };//ball is life
 MovLayer ml1 = { &p1, {0,0}, &ml3 }; //player paddle
 MovLayer ml0 = { &p0, {2,0}, &ml1 };//cpu paddle 
 
+DirtyRegions dirty;		/**< areas to redraw this frame */
+
 void movLayerDraw(MovLayer *movLayers, Layer *layers)
 {
-  int row, col;
   MovLayer *movLayer;
 
   and_sr(~8);			/**< disable interrupts (GIE off) */
@@ -93,27 +96,10 @@ void movLayerDraw(MovLayer *movLayers, Layer *layers)
   }
   or_sr(8);			/**< disable interrupts (GIE on) */
 
-  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
-    Region bounds;
-    layerGetBounds(movLayer->layer, &bounds);
-    lcd_setArea(bounds.topLeft.axes[0], bounds.topLeft.axes[1], 
-		bounds.botRight.axes[0], bounds.botRight.axes[1]);
-    for (row = bounds.topLeft.axes[1]; row <= bounds.botRight.axes[1]; row++) {
-      for (col = bounds.topLeft.axes[0]; col <= bounds.botRight.axes[0]; col++) {
-	Vec2 pixelPos = {col, row};
-	u_int color = bgColor;
-	Layer *probeLayer;
-	for (probeLayer = layers; probeLayer; 
-	     probeLayer = probeLayer->next) { /* probe all layers, in order */
-	  if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
-	    color = probeLayer->color;
-	    break; 
-	  } /* if probe check */
-	} // for checking all layers at col, row
-	lcd_writeColor(color); 
-      } // for col
-    } // for row
-  } // for moving layer being updated
+  dirtyInit(&dirty);
+  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) /* for each moving layer */
+    dirtyAddLayer(&dirty, movLayer->layer);
+  dirtyDraw(&dirty, layers);	/**< each changed pixel once */
 }	  
 
 
@@ -223,17 +209,20 @@ void main()
   P1OUT |= GREEN_LED;
 
   configureClocks();
-  lcd_init();
+  lcd_initAsync(0);		/**< the panel resets while we set up */
+  or_sr(0x8);			/**< GIE: lcd init is interrupt driven */
   shapeInit();
   p2sw_init(15);
   buzzer_init();
   shapeInit();
 
   layerInit(&p0);
-  layerDraw(&p0);
-
-
   layerGetBounds(&fieldLayer, &fieldFence);
+  textFieldInit(&pScoreField, 0, 0, COLOR_PURPLE, COLOR_BLACK);
+  textFieldInit(&cScoreField, 85, 0, COLOR_ORANGE, COLOR_BLACK);
+
+  lcd_waitReady();
+  layerDraw(&p0);
   
 
   enableWDTInterrupts();      /**< enable periodic interrupt */
@@ -241,21 +230,27 @@ void main()
   
    
   for(;;) { 
-    drawString5x7(0,0, pScore, COLOR_PURPLE, COLOR_BLACK);
-    drawString5x7(85,0, cScore, COLOR_ORANGE, COLOR_BLACK);
     while (!redrawScreen) { /**< Pause CPU if screen doesn't need updating */
       P1OUT &= ~GREEN_LED;    /**< Green led off witHo CPU */
       or_sr(0x10);	      /**< CPU OFF */
     }
     P1OUT |= GREEN_LED;       /**< Green led on when CPU on */
     redrawScreen = 0;
+    clockSetProfile(CLOCK_FAST); /**< 8 MHz SPI while drawing */
     movLayerDraw(&ml0, &p0);
+    textFieldUpdate(&pScoreField, pScore);
+    textFieldUpdate(&cScoreField, cScore);
+    lcd_flush();		/**< finish sending before slowing down */
+    clockSetProfile(CLOCK_SLOW);
   }
 }
 unsigned char paused = 0;
 /** Watchdog timer interrupt handler. 15 interrupts/sec */
 void wdt_c_handler()
 {
+  static short count = 0;
+  if (!clockWdtTick())		/**< skipped interrupt (CLOCK_MAX) */
+    return;
   int yBall = ml3.layer->pos.axes[0];// gets y location of ball
   int yPaddle = ml0.layer->pos.axes[0];// gets y location of cpu paddle 
   if(yBall < yPaddle){//cpu paddle follows ball
@@ -280,7 +275,6 @@ void wdt_c_handler()
     ml1.velocity.axes[0] = -2;//moves paddle left
   }
   
-  static short count = 0;
   P1OUT |= GREEN_LED;		      /**< Green LED on when cpu on */
   //wont update anyuthing if paused
   if(!paused){
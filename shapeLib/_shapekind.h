@@ -0,0 +1,230 @@
+/** \file _shapekind.h
+ *  \brief Inline check and span kernels for the built-in AbShape kinds
+ *
+ *  abShapeCheck and the layer renderer switch on AbShape.kind into
+ *  these, so drawing a built-in shape costs no indirect calls and no
+ *  calls to the vec2 and bounds helpers.  The shapes' own check and
+ *  getSpans functions are wrappers around the same kernels.
+ */
+
+#ifndef _shapekind_included
+#define _shapekind_included
+
+#include "shape.h"
+
+static inline int
+kernelRectCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  int dCol = pixel->axes[0] - centerPos->axes[0];
+  int dRow = pixel->axes[1] - centerPos->axes[1];
+  int halfCols = rect->halfSize.axes[0], halfRows = rect->halfSize.axes[1];
+  return dCol >= -halfCols && dCol <= halfCols && dRow >= -halfRows && dRow <= halfRows;
+}
+
+static inline int
+kernelRectSpans(const AbRect *rect, const Vec2 *centerPos, int row, Span spans[])
+{
+  int dRow = row - centerPos->axes[1];
+  if (dRow < -rect->halfSize.axes[1] || dRow > rect->halfSize.axes[1])
+    return 0;
+  spans[0].start = centerPos->axes[0] - rect->halfSize.axes[0];
+  spans[0].end = centerPos->axes[0] + rect->halfSize.axes[0];
+  return 1;
+}
+
+static inline int
+kernelRectOutlineCheck(const AbRectOutline *rect, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  int dCol = pixel->axes[0] - centerPos->axes[0];
+  int dRow = pixel->axes[1] - centerPos->axes[1];
+  int halfCols = rect->halfSize.axes[0], halfRows = rect->halfSize.axes[1];
+  if (dCol < -halfCols || dCol > halfCols || dRow < -halfRows || dRow > halfRows)
+    return 0;
+  return dCol == -halfCols || dCol == halfCols || dRow == -halfRows || dRow == halfRows;
+}
+
+/* the top and bottom edges, or the two sides */
+static inline int
+kernelRectOutlineSpans(const AbRectOutline *rect, const Vec2 *centerPos, int row, Span spans[])
+{
+  int dRow = row - centerPos->axes[1], halfRows = rect->halfSize.axes[1];
+  int left = centerPos->axes[0] - rect->halfSize.axes[0];
+  int right = centerPos->axes[0] + rect->halfSize.axes[0];
+  if (dRow < -halfRows || dRow > halfRows)
+    return 0;
+  if (dRow == -halfRows || dRow == halfRows || left == right) {
+    spans[0].start = left;
+    spans[0].end = right;
+    return 1;
+  }
+  spans[0].start = spans[0].end = left;
+  spans[1].start = spans[1].end = right;
+  return 2;
+}
+
+static inline int
+kernelRArrowCheck(const AbRArrow *arrow, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  int size = arrow->size, halfSize = size/2, quarterSize = halfSize/2;
+  int col = centerPos->axes[0] - pixel->axes[0]; /* note that col is negated */
+  int row = pixel->axes[1] - centerPos->axes[1];
+  row = (row >= 0) ? row : -row;	/* row = |row| */
+  if (col < 0)			/* right of arrow */
+    return 0;
+  if (col <= halfSize)		/* within arrow tip */
+    return row <= col;
+  return col <= size && row <= quarterSize; /* within arrow stem */
+}
+
+/* The tip covers |row| <= col <= size/2 left of the tip, the stem
+ * |row| <= size/4 out to col = size; together one span per row. */
+static inline int
+kernelRArrowSpans(const AbRArrow *arrow, const Vec2 *centerPos, int row, Span spans[])
+{
+  int size = arrow->size, halfSize = size/2, quarterSize = halfSize/2;
+  int dRow = row - centerPos->axes[1];
+  int colMax;
+  dRow = (dRow >= 0) ? dRow : -dRow;
+  if (dRow <= quarterSize)
+    colMax = size;		/* tip and stem */
+  else if (dRow <= halfSize)
+    colMax = halfSize;		/* tip only */
+  else
+    return 0;
+  spans[0].start = centerPos->axes[0] - colMax;
+  spans[0].end = centerPos->axes[0] - dRow;
+  return 1;
+}
+
+static inline int
+kernelCircleCheck(const AbCircle *circle, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  int dCol = pixel->axes[0] - centerPos->axes[0];
+  int dRow = pixel->axes[1] - centerPos->axes[1];
+  dCol = (dCol >= 0) ? dCol : -dCol;	/* project to first quadrant */
+  dRow = (dRow >= 0) ? dRow : -dRow;
+  return dCol <= circle->radius && circle->chords[dCol] >= dRow;
+}
+
+/* the row's chord: columns whose chords reach the row's distance from center */
+static inline int
+kernelCircleSpans(const AbCircle *circle, const Vec2 *centerPos, int row, Span spans[])
+{
+  const u_char *chords = circle->chords;
+  u_char radius = circle->radius;
+  int dRow = row - centerPos->axes[1], dCol;
+  dRow = (dRow >= 0) ? dRow : -dRow;
+  if (dRow > radius)
+    return 0;
+  /* chords is symmetric up to rounding: start from the mirrored entry */
+  dCol = chords[dRow];
+  while (dCol < radius && chords[dCol + 1] >= dRow)
+    dCol++;
+  while (chords[dCol] < dRow)
+    dCol--;
+  spans[0].start = centerPos->axes[0] - dCol;
+  spans[0].end = centerPos->axes[0] + dCol;
+  return 1;
+}
+
+/** Check shape at pixel, inline for built-in kinds */
+static inline int
+shapeKindCheck(const AbShape *shape, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  switch (shape->kind) {
+  case ABSHAPE_RECT:
+    return kernelRectCheck((const AbRect *)shape, centerPos, pixel);
+  case ABSHAPE_RECT_OUTLINE:
+    return kernelRectOutlineCheck((const AbRectOutline *)shape, centerPos, pixel);
+  case ABSHAPE_RARROW:
+    return kernelRArrowCheck((const AbRArrow *)shape, centerPos, pixel);
+  case ABSHAPE_CIRCLE:
+    return kernelCircleCheck((const AbCircle *)shape, centerPos, pixel);
+  default:
+    return shape->check(shape, centerPos, pixel);
+  }
+}
+
+/** True if shape covers every pixel of its bounds */
+static inline int
+shapeKindFillsBounds(const AbShape *shape)
+{
+  return shape->kind == ABSHAPE_RECT;
+}
+
+/** Computes a rectangle of pixels shape is sure to cover: the whole
+ *  of a rect, the square inscribed in a circle or an arrow's stem
+ *
+ *  \return 0 if shape declares no such rectangle
+ */
+static inline int
+shapeKindOpaque(const AbShape *shape, const Vec2 *centerPos, Region *opaque)
+{
+  int col = centerPos->axes[0], row = centerPos->axes[1];
+  int left, right, halfRows;
+  switch (shape->kind) {
+  case ABSHAPE_RECT: {
+    const AbRect *rect = (const AbRect *)shape;
+    left = col - rect->halfSize.axes[0];
+    right = col + rect->halfSize.axes[0];
+    halfRows = rect->halfSize.axes[1];
+    break;
+  }
+  case ABSHAPE_CIRCLE: {
+    const AbCircle *circle = (const AbCircle *)shape;
+    int d = (circle->radius * 181) >> 8; /* about radius / sqrt(2) */
+    while (d < circle->radius && circle->chords[d + 1] >= d + 1)
+      d++;
+    while (circle->chords[d] < d)
+      d--;
+    left = col - d;
+    right = col + d;
+    halfRows = d;
+    break;
+  }
+  case ABSHAPE_RARROW: {
+    int size = ((const AbRArrow *)shape)->size, quarterSize = size/2/2;
+    left = col - size;		/* the stem, and the tip as wide on its rows */
+    right = col - quarterSize;
+    halfRows = quarterSize;
+    break;
+  }
+  default:
+    return 0;
+  }
+  opaque->topLeft.axes[0] = left;
+  opaque->botRight.axes[0] = right;
+  opaque->topLeft.axes[1] = row - halfRows;
+  opaque->botRight.axes[1] = row + halfRows;
+  return 1;
+}
+
+/** True if shapeKindSpans can describe shape's rows */
+static inline int
+shapeKindHasSpans(const AbShape *shape)
+{
+  return shape->kind != ABSHAPE_CUSTOM || shape->getSpans;
+}
+
+/** Spans of shape in row, inline for built-in kinds
+ *
+ *  \return the number of spans, or -1 if the shape has no getSpans
+ */
+static inline int
+shapeKindSpans(const AbShape *shape, const Vec2 *centerPos, int row, Span spans[])
+{
+  switch (shape->kind) {
+  case ABSHAPE_RECT:
+    return kernelRectSpans((const AbRect *)shape, centerPos, row, spans);
+  case ABSHAPE_RECT_OUTLINE:
+    return kernelRectOutlineSpans((const AbRectOutline *)shape, centerPos, row, spans);
+  case ABSHAPE_RARROW:
+    return kernelRArrowSpans((const AbRArrow *)shape, centerPos, row, spans);
+  case ABSHAPE_CIRCLE:
+    return kernelCircleSpans((const AbCircle *)shape, centerPos, row, spans);
+  default:
+    return shape->getSpans ? shape->getSpans(shape, centerPos, row, spans) : -1;
+  }
+}
+
+#endif // included
@@ -0,0 +1,171 @@
+#include "lcddriver.h"
+#include "shape.h"
+#include "_shapekind.h"
+
+/* Cost model, in bytes sent to the lcd: a window costs CASET, PASET
+ * and RAMWR with their parameters, a pixel two bytes.  Windows cost
+ * nothing on drivers with LCD_CAP_CHEAPWIN, so rects are merged there
+ * only when the bounding box adds no pixels. */
+#define WINDOW_COST ((lcdDriver->caps & LCD_CAP_CHEAPWIN) ? 0 : 11)
+#define PIXEL_COST 2
+
+#define DIRTY_WORK 6		/* pieces queued by addPieces; more: merge */
+
+/* true if drawing the union of r1 and r2 costs no more than drawing
+ * r2 and the part of r1 outside it */
+static int
+worthMerging(const Region *r1, const Region *r2)
+{
+  Region u, overlap;
+  long overlapArea = regionIntersect(&overlap, r1, r2) ? regionArea(&overlap) : 0;
+  regionUnion(&u, r1, r2);
+  return WINDOW_COST + PIXEL_COST * regionArea(&u) <=
+    2 * WINDOW_COST + PIXEL_COST * (regionArea(r1) + regionArea(r2) - overlapArea);
+}
+
+static void
+removeRect(DirtyRegions *dirty, u_char i)
+{
+  dirty->rects[i] = dirty->rects[--dirty->count];
+}
+
+/* grow area by the rects it overlaps until it overlaps none */
+static void
+absorbOverlapping(DirtyRegions *dirty, Region *area)
+{
+  u_char i = 0;
+  while (i < dirty->count) {
+    if (regionOverlaps(area, &dirty->rects[i])) {
+      regionUnion(area, area, &dirty->rects[i]);
+      removeRect(dirty, i);
+      i = 0;			/* the union may reach earlier rects */
+    } else
+      i++;
+  }
+}
+
+/* pixels added by drawing the bounding box of two disjoint rects */
+static long
+mergeWaste(const Region *r1, const Region *r2)
+{
+  Region u;
+  regionUnion(&u, r1, r2);
+  return regionArea(&u) - regionArea(r1) - regionArea(r2);
+}
+
+/* Add area, which is worth merging with no rect.  A piece that
+ * overlaps a rect is split around it (regionSubtract) and its parts
+ * are queued; when the queue has no room for them, the rect grows to
+ * cover the piece instead.  While the set is full, the two rects (or
+ * the piece and a rect) whose bounding box wastes the fewest pixels
+ * are merged.
+ *
+ * Nothing recurses: the worst case stack below dirtyAddLayer is about
+ * 200 bytes on the msp430, 48 of them the queue. */
+static void
+addPieces(DirtyRegions *dirty, const Region *area)
+{
+  Region work[DIRTY_WORK], piece, merged;
+  u_char n = 1, i, j;
+  work[0] = *area;
+  while (n) {
+    long best = 0x7fffffffL;
+    u_char bestI = 0, bestJ = 0;
+    piece = work[--n];
+    for (i = 0; i < dirty->count && !regionOverlaps(&piece, &dirty->rects[i]); i++)
+      ;
+    if (i < dirty->count) {
+      if (n + 4 <= DIRTY_WORK) {
+	n += regionSubtract(&work[n], &piece, &dirty->rects[i]);
+      } else {			/* no room to split: rect i covers piece */
+	regionUnion(&merged, &piece, &dirty->rects[i]);
+	removeRect(dirty, i);
+	absorbOverlapping(dirty, &merged);
+	dirty->rects[dirty->count++] = merged;
+      }
+      continue;
+    }
+    if (dirty->count < DIRTY_MAX) {
+      dirty->rects[dirty->count++] = piece;
+      continue;
+    }
+    for (i = 0; i < dirty->count; i++) /* j == count stands for piece */
+      for (j = i + 1; j <= dirty->count; j++) {
+	long waste = mergeWaste(&dirty->rects[i], j < dirty->count ? &dirty->rects[j] : &piece);
+	if (waste < best) {
+	  best = waste;
+	  bestI = i;
+	  bestJ = j;
+	}
+      }
+    if (bestJ == dirty->count) { /* piece joins a rect */
+      regionUnion(&merged, &piece, &dirty->rects[bestI]);
+      removeRect(dirty, bestI);
+    } else {
+      regionUnion(&merged, &dirty->rects[bestI], &dirty->rects[bestJ]);
+      removeRect(dirty, bestJ);	/* the higher index first */
+      removeRect(dirty, bestI);
+      work[n++] = piece;	/* then add piece again */
+    }
+    absorbOverlapping(dirty, &merged);
+    dirty->rects[dirty->count++] = merged;
+  }
+}
+
+void
+dirtyInit(DirtyRegions *dirty)
+{
+  dirty->count = 0;
+}
+
+void
+dirtyAdd(DirtyRegions *dirty, const Region *area)
+{
+  Region r = *area;
+  u_char i = 0;
+  regionClipScreen(&r);
+  if (regionIsEmpty(&r))
+    return;			/* nothing on screen */
+  while (i < dirty->count) {
+    if (worthMerging(&dirty->rects[i], &r)) {
+      regionUnion(&r, &r, &dirty->rects[i]);
+      removeRect(dirty, i);
+      i = 0;			/* the union may now be worth merging with others */
+    } else
+      i++;
+  }
+  addPieces(dirty, &r);
+}
+
+void
+dirtyAddLayer(DirtyRegions *dirty, Layer *l)
+{
+  Region last, cur, pieces[4];
+  u_char i, n;
+  abShapeGetBounds(l->abShape, &l->posLast, &last);
+  abShapeGetBounds(l->abShape, &l->pos, &cur);
+  if (shapeKindFillsBounds(l->abShape) && l->color == l->colorLast &&
+      regionOverlaps(&last, &cur)) {
+    /* an opaque shape slid: only the strips it left and entered change */
+    n = regionSubtract(pieces, &last, &cur);
+    for (i = 0; i < n; i++)
+      dirtyAdd(dirty, &pieces[i]);
+    n = regionSubtract(pieces, &cur, &last);
+    for (i = 0; i < n; i++)
+      dirtyAdd(dirty, &pieces[i]);
+  } else {
+    dirtyAdd(dirty, &last);
+    dirtyAdd(dirty, &cur);
+  }
+  l->colorLast = l->color;
+}
+
+void
+dirtyDraw(DirtyRegions *dirty, Layer *layers)
+{
+  u_char i;
+  for (i = 0; i < dirty->count; i++)
+    layerDrawRegion(layers, &dirty->rects[i]);
+  drv_frameDone();
+  dirty->count = 0;
+}
@@ -0,0 +1,168 @@
+/** \file drivercheck.c
+ *  \brief Renders one layer scene through lcdSt7735Driver and
+ *  lcdMonoDriver and checks what each displays (host only)
+ *
+ *  Every pixel read back with lcdsim_getPixel must have the color of
+ *  the topmost layer containing it (or bgColor); every pixel read
+ *  back with lcdmono_getPixel must be that color thresholded by
+ *  MONO_LIT.  On the mono driver, each flush must hand the page sink
+ *  exactly the pages whose bytes changed, from their first to their
+ *  last changed column.  Exits with status 1 on any mismatch.
+ */
+#include <stdio.h>
+#include <libTimer.h>
+#include "lcdutils.h"
+#include "lcddriver.h"
+#include "lcdmono.h"
+#include "lcdsim.h"
+#include "shape.h"
+
+const AbRect rect = {abRectGetBounds, abRectCheck, abRectGetSpans, ABSHAPE_RECT, {10,6}};
+const AbRectOutline outline = {abRectOutlineGetBounds, abRectOutlineCheck, abRectOutlineGetSpans,
+			       ABSHAPE_RECT_OUTLINE, {14,9}};
+const AbRArrow arrow = {abRArrowGetBounds, abRArrowCheck, abRArrowGetSpans, ABSHAPE_RARROW, 20};
+
+/* within the mono panel; layer1 is dark enough to be unlit over the
+ * lit rect below it */
+Layer layer3 = {(AbShape *)&arrow, {110,30}, {0,0}, {0,0}, COLOR_RED, 0};
+Layer layer2 = {(AbShape *)&rect, {30,40}, {0,0}, {0,0}, COLOR_GREEN, &layer3};
+Layer layer1 = {(AbShape *)&rect, {38,46}, {0,0}, {0,0}, COLOR_DARK_GREEN, &layer2};
+Layer layer0 = {(AbShape *)&outline, {64,20}, {0,0}, {0,0}, COLOR_WHITE, &layer1};
+
+u_int bgColor = COLOR_BLACK;
+
+static int errors;
+
+static void
+fail(const char *what, int col, int row)
+{
+  if (errors++ < 10)
+    printf("drivercheck: %s at %d,%d\n", what, col, row);
+}
+
+/** Color of the topmost layer containing col,row */
+static u_int
+sceneColor(int col, int row)
+{
+  Vec2 pixel = {col, row};
+  Layer *l;
+  for (l = &layer0; l; l = l->next)
+    if (abShapeCheck(l->abShape, &l->pos, &pixel))
+      return l->color;
+  return bgColor;
+}
+
+/** Place the layers and draw the whole screen */
+static void
+drawScene()
+{
+  layer0.pos.axes[0] = 64; layer0.pos.axes[1] = 20;
+  layer2.pos.axes[0] = 30; layer2.pos.axes[1] = 40;
+  layerInit(&layer0);
+  layerDraw(&layer0);
+}
+
+/** Move layers 0 and 2 and redraw what changed */
+static void
+moveScene(int dCol, int dRow)
+{
+  DirtyRegions dirty;
+  Layer *moved[] = {&layer0, &layer2};
+  int i;
+  dirtyInit(&dirty);
+  for (i = 0; i < 2; i++) {
+    Layer *l = moved[i];
+    l->posLast = l->pos;
+    l->pos.axes[0] += dCol;
+    l->pos.axes[1] += dRow;
+    dirtyAddLayer(&dirty, l);
+  }
+  dirtyDraw(&dirty, &layer0);
+}
+
+static void
+checkSt7735(const char *when)
+{
+  int col, row;
+  for (row = 0; row < screenHeight; row++)
+    for (col = 0; col < screenWidth; col++)
+      if (lcdsim_getPixel(col, row) != sceneColor(col, row))
+	fail(when, col, row);
+}
+
+/* page sink: which pages and columns arrived, and what they hold */
+static u_char sinkCalls[MONO_PAGES], sinkColStart[MONO_PAGES], sinkColEnd[MONO_PAGES];
+static u_char panel[MONO_PAGES][MONO_WIDTH];
+
+static void
+pageSink(u_char page, u_char colStart, u_char colEnd, const u_char *bytes)
+{
+  u_char col;
+  sinkCalls[page]++;
+  sinkColStart[page] = colStart;
+  sinkColEnd[page] = colEnd;
+  for (col = colStart; col <= colEnd; col++)
+    panel[page][col] = bytes[col - colStart];
+}
+
+static u_char shown[MONO_HEIGHT][MONO_WIDTH]; /* lit before the frame */
+
+/** Check the framebuffer, the panel and the sink calls of the frame
+ *  just flushed, then remember what it shows
+ */
+static void
+checkMono(const char *when)
+{
+  int col, row, page;
+  for (page = 0; page < MONO_PAGES; page++) {
+    int first = -1, last = -1;
+    for (col = 0; col < MONO_WIDTH; col++)
+      for (row = page * 8; row < page * 8 + 8; row++) {
+	u_char lit = lcdmono_getPixel(col, row);
+	if (lit != MONO_LIT(sceneColor(col, row)))
+	  fail(when, col, row);
+	if (lit != ((panel[page][col] >> (row & 7)) & 1))
+	  fail("panel differs from framebuffer", col, row);
+	if (lit != shown[row][col]) {
+	  if (first < 0)
+	    first = col;
+	  last = col;
+	}
+	shown[row][col] = lit;
+      }
+    if (first < 0 ? sinkCalls[page] != 0 :
+	sinkCalls[page] != 1 || sinkColStart[page] != first || sinkColEnd[page] != last) {
+      printf("drivercheck: %s: page %d sent %d times, cols %d..%d; changed cols %d..%d\n",
+	     when, page, sinkCalls[page], sinkColStart[page], sinkColEnd[page], first, last);
+      errors++;
+    }
+    sinkCalls[page] = 0;
+  }
+}
+
+int
+main()
+{
+  configureClocks();
+  lcd_init();
+
+  lcdDriver = &lcdSt7735Driver;
+  drawScene();
+  checkSt7735("st7735 draw");
+  moveScene(3, 2);
+  checkSt7735("st7735 move");
+
+  lcdDriver = &lcdMonoDriver;
+  lcdmono_setPageSink(pageSink);
+  drawScene();
+  checkMono("mono draw");
+  moveScene(3, 2);
+  checkMono("mono move");
+  moveScene(0, 0);		/* redraws, changes nothing */
+  checkMono("mono redraw");
+  moveScene(-20, 9);		/* rect moves down into pages 6 and 7 */
+  checkMono("mono move 2");
+
+  printf("drivercheck: %s\n", errors ? "FAILED" : "ok");
+  return errors != 0;
+}
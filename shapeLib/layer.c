@@ -1,26 +1,327 @@
 #include "lcdutils.h"
 #include "lcddraw.h"
+#include "lcddriver.h"
 #include "shape.h"
+#include "_shapekind.h"
 
-void
-layerDraw(Layer *layers)
+#define LAYER_ROW_SPANS 12	/* spans merged per row; more: probe per pixel */
+
+/** A layer's span within the row being drawn */
+typedef struct {
+  int start, end;		/* clipped to the area drawn */
+  Layer *layer;
+} LayerSpan;
+
+#define LAYER_SCAN_MAX 8		/* layers tracked per area; more: walk the list */
+
+/** A layer whose bounds meet the area being drawn */
+typedef struct {
+  Layer *layer;
+  int top, bottom;		/* its rows within the area */
+} ScanLayer;
+
+/** Scanline state: the layers meeting the area, in list (z) order,
+ *  their entry order by top row, and those covering the current row
+ */
+typedef struct {
+  ScanLayer layers[LAYER_SCAN_MAX];
+  u_char count;
+  u_char entries[LAYER_SCAN_MAX];	/* indices into layers by top row */
+  u_char nextEntry;
+  u_char active[LAYER_SCAN_MAX];	/* indices into layers, in z order */
+  u_char activeCount;
+} Scanline;
+
+unsigned long layerProbes;
+
+/** Check whether layer l's shape contains pixel, counting the probe */
+static inline int
+layerProbe(Layer *l, const Vec2 *pixel)
+{
+  layerProbes++;
+  return shapeKindCheck(l->abShape, &l->pos, pixel);
+}
+
+/** Compute the bounds of every layer once and sort the layers
+ *  meeting area into entry events
+ *
+ *  \return 0 if more than LAYER_SCAN_MAX layers meet area
+ */
+static int
+scanInit(Scanline *scan, Layer *layers, const Region *area)
+{
+  Layer *l;
+  u_char j;
+  scan->count = scan->nextEntry = scan->activeCount = 0;
+  for (l = layers; l; l = l->next) {
+    Region bounds;
+    ScanLayer *sl;
+    abShapeGetBounds(l->abShape, &l->pos, &bounds);
+    if (!regionOverlaps(&bounds, area))
+      continue;			/* cannot cover a pixel of area */
+    if (scan->count == LAYER_SCAN_MAX)
+      return 0;
+    sl = &scan->layers[scan->count];
+    sl->layer = l;
+    sl->top = bounds.topLeft.axes[1];
+    sl->bottom = bounds.botRight.axes[1];
+    for (j = scan->count; j && scan->layers[scan->entries[j-1]].top > sl->top; j--)
+      scan->entries[j] = scan->entries[j-1]; /* insertion sort by top */
+    scan->entries[j] = scan->count++;
+  }
+  return 1;
+}
+
+/** Update the active list for row: drop layers that ended above it,
+ *  add those starting at or above it, keeping z order
+ */
+static void
+scanAdvance(Scanline *scan, int row)
+{
+  u_char i, j, n = 0;
+  for (i = 0; i < scan->activeCount; i++) /* exits */
+    if (scan->layers[scan->active[i]].bottom >= row)
+      scan->active[n++] = scan->active[i];
+  while (scan->nextEntry < scan->count &&
+	 scan->layers[scan->entries[scan->nextEntry]].top <= row) { /* entries */
+    u_char entering = scan->entries[scan->nextEntry++];
+    for (j = n; j && scan->active[j-1] > entering; j--)
+      scan->active[j] = scan->active[j-1];
+    scan->active[j] = entering;
+    n++;
+  }
+  scan->activeCount = n;
+}
+
+/** Columns of row that layer l's opaque rectangle covers
+ *
+ *  \return 0 if it covers none
+ */
+static int
+layerOpaqueSpan(Layer *l, int row, Span *opaque)
+{
+  Region r;
+  if (!shapeKindOpaque(l->abShape, &l->pos, &r) ||
+      row < r.topLeft.axes[1] || row > r.botRight.axes[1])
+    return 0;
+  opaque->start = r.topLeft.axes[0];
+  opaque->end = r.botRight.axes[0];
+  return 1;
+}
+
+/** Append the spans of layer l in row, clipped to colStart..colEnd
+ *  and trimmed where they end under cover, the columns hidden by
+ *  opaque layers above.  Layers without getSpans contribute their
+ *  bounds, to be probed pixel by pixel.  Then adds l's opaque columns
+ *  to cover (cover stays one interval: the wider one if disjoint).
+ *
+ *  \return the new number of spans, or -1 if there are too many
+ */
+static int
+layerSpans(Layer *l, int row, int colStart, int colEnd, Span *cover, LayerSpan spans[], int n)
 {
-  int row, col;
-  for (row = 0; row < screenHeight; row++) {
-    lcd_setArea(0, row, screenWidth-1, row);
-    for (col = 0; col < screenWidth; col++) {
-      Vec2 pixelPos = {col, row};
-      u_int color = bgColor;
-      Layer *probeLayer;
+  const AbShape *s = l->abShape;
+  Span shapeSpans[SHAPE_SPANS_MAX], opaque;
+  int i, count = shapeKindSpans(s, &l->pos, row, shapeSpans);
+  if (count < 0) {
+    Region bounds;
+    abShapeGetBounds(s, &l->pos, &bounds);
+    count = row >= bounds.topLeft.axes[1] && row <= bounds.botRight.axes[1];
+    shapeSpans[0].start = bounds.topLeft.axes[0];
+    shapeSpans[0].end = bounds.botRight.axes[0];
+  }
+  for (i = 0; i < count; i++) {
+    int start = shapeSpans[i].start, end = shapeSpans[i].end;
+    if (start < colStart) start = colStart;
+    if (end > colEnd) end = colEnd;
+    if (start >= cover->start && start <= cover->end)
+      start = cover->end + 1;
+    if (end >= cover->start && end <= cover->end)
+      end = cover->start - 1;
+    if (start > end)
+      continue;
+    if (n == LAYER_ROW_SPANS)
+      return -1;
+    spans[n].start = start;
+    spans[n].end = end;
+    spans[n].layer = l;
+    n++;
+  }
+  if (layerOpaqueSpan(l, row, &opaque)) {
+    if (opaque.start <= cover->end + 1 && opaque.end >= cover->start - 1) {
+      if (opaque.start < cover->start) cover->start = opaque.start;
+      if (opaque.end > cover->end) cover->end = opaque.end;
+    } else if (opaque.end - opaque.start > cover->end - cover->start) {
+      *cover = opaque;
+    }
+  }
+  return n;
+}
+
+/** Collect the spans in row, top layer first: of the active layers,
+ *  or of all layers if scan is 0.  Stops at the first layer under
+ *  opaque layers covering all of colStart..colEnd.
+ *
+ *  \return the number of spans, or -1 if there are too many
+ */
+static int
+rowSpans(const Scanline *scan, Layer *layers, int row, int colStart, int colEnd, LayerSpan spans[])
+{
+  int n = 0;
+  Span cover = {colEnd + 1, colEnd}; /* empty */
+  if (scan) {
+    u_char i;
+    for (i = 0; i < scan->activeCount && n >= 0; i++) {
+      if (cover.start <= colStart && cover.end >= colEnd)
+	break;			/* the rest are hidden */
+      n = layerSpans(scan->layers[scan->active[i]].layer, row, colStart, colEnd, &cover, spans, n);
+    }
+  } else {
+    Layer *l;
+    for (l = layers; l && n >= 0; l = l->next) {
+      if (cover.start <= colStart && cover.end >= colEnd)
+	break;
+      n = layerSpans(l, row, colStart, colEnd, &cover, spans, n);
+    }
+  }
+  return n;
+}
+
+/** Probe every layer at each pixel of the row (the active layers
+ *  if scan is not 0).  A pixel within an active layer's opaque
+ *  rectangle needs no probe of it or of the layers below, and the
+ *  topmost active layer's opaque columns are one run.
+ */
+static void
+rowProbe(LcdRun *run, const Scanline *scan, Layer *layers, int row, int colStart, int colEnd)
+{
+  Span opaque[LAYER_SCAN_MAX];
+  int col;
+  u_char i;
+  if (scan)
+    for (i = 0; i < scan->activeCount; i++)
+      if (!layerOpaqueSpan(scan->layers[scan->active[i]].layer, row, &opaque[i]))
+	opaque[i].start = colEnd + 1, opaque[i].end = colEnd; /* none */
+  for (col = colStart; col <= colEnd; col++) {
+    Vec2 pixelPos = {col, row};
+    u_int color = bgColor;
+    Layer *probeLayer;
+    if (scan) {
+      for (i = 0; i < scan->activeCount; i++) {
+	probeLayer = scan->layers[scan->active[i]].layer;
+	if (col >= opaque[i].start && col <= opaque[i].end) {
+	  color = probeLayer->color;
+	  if (i == 0) {		/* nothing above: the run reaches its end */
+	    int end = opaque[0].end < colEnd ? opaque[0].end : colEnd;
+	    drv_runAddCount(run, color, end - col);
+	    col = end;
+	  }
+	  break;
+	}
+	if (layerProbe(probeLayer, &pixelPos)) {
+	  color = probeLayer->color;
+	  break;
+	}
+      }
+    } else {
       for (probeLayer = layers; probeLayer; probeLayer = probeLayer->next) {
-	if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
+	if (layerProbe(probeLayer, &pixelPos)) {
 	  color = probeLayer->color;
 	  break; 
 	} /* if check */
       } // for checking all layers at col, row
-      lcd_writeColor(color); 
-    } // for col
+    }
+    drv_runAdd(run, color);
+  } // for col
+}
+
+/** Compose a row from its spans
+ *
+ *  Splits the row where the topmost covering span can change.  A
+ *  piece whose top span is exact is one run of its layer's color;
+ *  under a probed span each pixel checks the covering spans in order.
+ */
+static void
+rowCompose(LcdRun *run, const LayerSpan spans[], int n, int row, int colStart, int colEnd)
+{
+  int col = colStart;
+  while (col <= colEnd) {
+    int i, next = colEnd + 1;
+    const LayerSpan *top = 0;
+    for (i = 0; i < n; i++) {
+      const LayerSpan *s = &spans[i];
+      if (s->start > col) {
+	if (s->start < next)
+	  next = s->start;	/* a span begins */
+      } else if (s->end >= col) {
+	if (s->end < next)
+	  next = s->end + 1;	/* a covering span ends */
+	if (!top) {
+	  top = s;
+	  if (shapeKindHasSpans(s->layer->abShape))
+	    break;		/* exact: lower spans are hidden */
+	}
+      }
+    }
+    if (!top) {
+      drv_runAddCount(run, bgColor, next - col);
+    } else if (shapeKindHasSpans(top->layer->abShape)) {
+      drv_runAddCount(run, top->layer->color, next - col);
+    } else {
+      for (; col < next; col++) {
+	Vec2 pixelPos = {col, row};
+	u_int color = bgColor;
+	const LayerSpan *s;
+	for (s = top; s < spans + n; s++) {
+	  Layer *l = s->layer;
+	  if (s->start <= col && s->end >= col &&
+	      (shapeKindHasSpans(l->abShape) || layerProbe(l, &pixelPos))) {
+	    color = l->color;
+	    break;
+	  }
+	}
+	drv_runAdd(run, color);
+      }
+    }
+    col = next;
+  }
+}
+
+void
+layerDrawRegion(Layer *layers, const Region *area)
+{
+  int row;
+  LcdRun run = {bgColor, 0};
+  LayerSpan spans[LAYER_ROW_SPANS];
+  Scanline scanline, *scan = &scanline;
+  Region r = *area;
+  
+  regionClipScreen(&r);
+  if (regionIsEmpty(&r))
+    return;			/* nothing on screen */
+  if (!scanInit(scan, layers, &r))
+    scan = 0;			/* too many layers: probe them all */
+  lcdDriver->window(r.topLeft.axes[0], r.topLeft.axes[1],
+		    r.botRight.axes[0], r.botRight.axes[1]);
+  for (row = r.topLeft.axes[1]; row <= r.botRight.axes[1]; row++) {
+    int n;
+    if (scan)
+      scanAdvance(scan, row);
+    n = rowSpans(scan, layers, row, r.topLeft.axes[0], r.botRight.axes[0], spans);
+    if (n < 0)
+      rowProbe(&run, scan, layers, row, r.topLeft.axes[0], r.botRight.axes[0]);
+    else
+      rowCompose(&run, spans, n, row, r.topLeft.axes[0], r.botRight.axes[0]);
   } // for row
+  drv_runFlush(&run);
+}
+
+void
+layerDraw(Layer *layers)
+{
+  Region screen = {{0, 0}, {lcdDriver->width - 1, lcdDriver->height - 1}};
+  layerDrawRegion(layers, &screen);
+  drv_frameDone();
 } 
 
 
@@ -38,7 +339,9 @@ layerGetBounds(const Layer *l, Region *bounds)
 void
 layerInit(Layer *layer)
 {
-  for (; layer; layer = layer->next)
+  for (; layer; layer = layer->next) {
     layer->posLast = layer->posNext = layer->pos;
+    layer->colorLast = layer->color;
+  }
 }
 
@@ -1,4 +1,5 @@
 #include "shape.h"
+#include "_shapekind.h"
 
 
 /** Check function required by AbShape
@@ -7,21 +8,16 @@
 int 
 abRArrowCheck(const AbRArrow *arrow, const Vec2 *centerPos, const Vec2 *pixel)
 {
-  Vec2 relPos;
-  int row, col, within = 0;
-  int size = arrow->size;
-  int halfSize = size/2, quarterSize = halfSize/2;;
-  vec2Sub(&relPos, pixel, centerPos); /* vector from center to pixel */
-  row = relPos.axes[1]; col = -relPos.axes[0]; /* note that col is negated */
-  row = (row >= 0) ? row : -row;/* row = |row| */
-  if (col >= 0) {		/* not to right of arrow */
-    if (col <= halfSize) {	/* within arrow tip */
-      within = row <= col;
-    } else if (col <= size) {	/* within arrow stem */
-      within = row <= quarterSize;
-    }
-  }
-  return within;
+  return kernelRArrowCheck(arrow, centerPos, pixel);
+}
+
+/** Spans function required by AbShape
+ *  One span per row: the tip and, near the axis, the stem
+ */
+int
+abRArrowGetSpans(const AbRArrow *arrow, const Vec2 *centerPos, int row, Span spans[])
+{
+  return kernelRArrowSpans(arrow, centerPos, row, spans);
 }
   
 /** Check function required by AbShape
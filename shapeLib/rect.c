@@ -1,18 +1,18 @@
 #include "shape.h"
+#include "_shapekind.h"
 
 // true if pixel is in rect centerPosed at rectPos
 int 
 abRectCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel)
 {
-  Region bounds;
-  abRectGetBounds(rect, centerPos, &bounds);
-  int within = 1, axis;
-  for (axis = 0; axis < 2; axis ++) {
-    int p = pixel->axes[axis];
-    if (p > bounds.botRight.axes[axis] || p < bounds.topLeft.axes[axis])
-      within = 0;
-  }
-  return within;
+  return kernelRectCheck(rect, centerPos, pixel);
+}
+
+// columns of row within rect at centerPos
+int
+abRectGetSpans(const AbRect *rect, const Vec2 *centerPos, int row, Span spans[])
+{
+  return kernelRectSpans(rect, centerPos, row, spans);
 }
 
 // compute bounding box in screen coordinates for rect at centerPos
@@ -28,18 +28,14 @@ void abRectGetBounds(const AbRect *rect, const Vec2 *centerPos, Region *bounds)
 int 
 abRectOutlineCheck(const AbRectOutline *rect, const Vec2 *centerPos, const Vec2 *pixel)
 {
-  Region bounds;
-  abRectOutlineGetBounds(rect, centerPos, &bounds);
-  int col = pixel->axes[0], row = pixel->axes[1];
-  return (
-	  ((col == bounds.topLeft.axes[0] || col == bounds.botRight.axes[0])
-	   && 
-	   (row >= bounds.topLeft.axes[1] && row <= bounds.botRight.axes[1]))
-	  ||
-	  ((row == bounds.topLeft.axes[1] || row == bounds.botRight.axes[1])
-	   &&
-	   (col >= bounds.topLeft.axes[0] && col <= bounds.botRight.axes[0]))
-	  );
+  return kernelRectOutlineCheck(rect, centerPos, pixel);
+}
+
+// columns of row on the outline: the top and bottom edges or two sides
+int
+abRectOutlineGetSpans(const AbRectOutline *rect, const Vec2 *centerPos, int row, Span spans[])
+{
+  return kernelRectOutlineSpans(rect, centerPos, row, spans);
 }
  
 // compute bounding box in screen coordinates for rect at centerPos
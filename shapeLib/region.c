@@ -1,3 +1,4 @@
+#include "lcddriver.h"
 #include "shape.h"
 
 // compute union of two regions
@@ -8,10 +9,84 @@ regionUnion(Region *rUnion, const Region *r1, const Region *r2)
   vec2Max(&rUnion->botRight, &r1->botRight, &r2->botRight);
 }
 
-// Trims extent of region to screen bounds
+// Trims extent of region to the display driver's screen (botRight is inclusive)
 void regionClipScreen(Region *r)
 {
+  Vec2 screenMax = {lcdDriver->width - 1, lcdDriver->height - 1};
   vec2Max(&r->topLeft, &r->topLeft, &vec2Zero);
-  vec2Min(&r->botRight, &r->botRight, &screenSize);
+  vec2Min(&r->botRight, &r->botRight, &screenMax);
 }
 
+// true if region contains no pixels
+int
+regionIsEmpty(const Region *r)
+{
+  return r->topLeft.axes[0] > r->botRight.axes[0] || r->topLeft.axes[1] > r->botRight.axes[1];
+}
+
+// number of pixels in region
+long
+regionArea(const Region *r)
+{
+  if (regionIsEmpty(r))
+    return 0;
+  return (long)(r->botRight.axes[0] - r->topLeft.axes[0] + 1) *
+    (r->botRight.axes[1] - r->topLeft.axes[1] + 1);
+}
+
+// true if the regions share a pixel
+int
+regionOverlaps(const Region *r1, const Region *r2)
+{
+  return r1->topLeft.axes[0] <= r2->botRight.axes[0] &&
+    r2->topLeft.axes[0] <= r1->botRight.axes[0] &&
+    r1->topLeft.axes[1] <= r2->botRight.axes[1] &&
+    r2->topLeft.axes[1] <= r1->botRight.axes[1];
+}
+
+// compute intersection of two regions; true if it is not empty
+int
+regionIntersect(Region *rIntersect, const Region *r1, const Region *r2)
+{
+  vec2Max(&rIntersect->topLeft, &r1->topLeft, &r2->topLeft);
+  vec2Min(&rIntersect->botRight, &r1->botRight, &r2->botRight);
+  return !regionIsEmpty(rIntersect);
+}
+
+// the parts of a outside b, top to bottom and left to right
+u_char
+regionSubtract(Region pieces[4], const Region *a, const Region *b)
+{
+  u_char n = 0;
+  int top = a->topLeft.axes[1], bottom = a->botRight.axes[1];
+  if (regionIsEmpty(a))
+    return 0;
+  if (!regionOverlaps(a, b)) {
+    pieces[0] = *a;
+    return 1;
+  }
+  if (top < b->topLeft.axes[1]) {		/* above b */
+    pieces[n] = *a;
+    pieces[n++].botRight.axes[1] = b->topLeft.axes[1] - 1;
+    top = b->topLeft.axes[1];
+  }
+  if (bottom > b->botRight.axes[1])		/* below b: added last */
+    bottom = b->botRight.axes[1];
+  if (a->topLeft.axes[0] < b->topLeft.axes[0]) { /* left of b */
+    pieces[n] = *a;
+    pieces[n].topLeft.axes[1] = top;
+    pieces[n].botRight.axes[1] = bottom;
+    pieces[n++].botRight.axes[0] = b->topLeft.axes[0] - 1;
+  }
+  if (a->botRight.axes[0] > b->botRight.axes[0]) { /* right of b */
+    pieces[n] = *a;
+    pieces[n].topLeft.axes[1] = top;
+    pieces[n].botRight.axes[1] = bottom;
+    pieces[n++].topLeft.axes[0] = b->botRight.axes[0] + 1;
+  }
+  if (bottom < a->botRight.axes[1]) {
+    pieces[n] = *a;
+    pieces[n++].topLeft.axes[1] = bottom + 1;
+  }
+  return n;
+}
@@ -0,0 +1,175 @@
+#include "shape.h"
+
+/* RegionSet operations sweep the rows of both sets band by band.
+ * Within a band each column interval between edges is kept or not
+ * depending on whether it is in a and/or b, as in X11's miRegionOp. */
+
+#define SET_UNION 0
+#define SET_INTERSECT 1
+#define SET_SUBTRACT 2
+
+#define NO_EDGE 0x7fff		/* beyond any coordinate */
+
+static int
+setOpKeeps(u_char op, int inA, int inB)
+{
+  switch (op) {
+  case SET_UNION:
+    return inA || inB;
+  case SET_INTERSECT:
+    return inA && inB;
+  default:
+    return inA && !inB;
+  }
+}
+
+/* first row edge (a top or a bottom + 1) of set after row */
+static int
+nextRowEdge(const RegionSet *set, int row)
+{
+  int next = NO_EDGE;
+  u_char i;
+  for (i = 0; i < set->count; i++) {
+    const Region *r = &set->rects[i];
+    if (r->topLeft.axes[1] > row) {
+      if (r->topLeft.axes[1] < next)
+	next = r->topLeft.axes[1];
+    } else if (r->botRight.axes[1] >= row && r->botRight.axes[1] < next) {
+      next = r->botRight.axes[1] + 1;
+    }
+  }
+  return next;
+}
+
+/* first column edge of set's rects in row after col */
+static int
+nextColEdge(const RegionSet *set, int row, int col)
+{
+  int next = NO_EDGE;
+  u_char i;
+  for (i = 0; i < set->count; i++) {
+    const Region *r = &set->rects[i];
+    if (r->topLeft.axes[1] > row || r->botRight.axes[1] < row)
+      continue;
+    if (r->topLeft.axes[0] > col) {
+      if (r->topLeft.axes[0] < next)
+	next = r->topLeft.axes[0];
+    } else if (r->botRight.axes[0] >= col && r->botRight.axes[0] < next) {
+      next = r->botRight.axes[0] + 1;
+    }
+  }
+  return next;
+}
+
+static int
+setContains(const RegionSet *set, int col, int row)
+{
+  u_char i;
+  for (i = 0; i < set->count; i++) {
+    const Region *r = &set->rects[i];
+    if (col >= r->topLeft.axes[0] && col <= r->botRight.axes[0] &&
+	row >= r->topLeft.axes[1] && row <= r->botRight.axes[1])
+      return 1;
+  }
+  return 0;
+}
+
+static int
+regionSetOp(RegionSet *result, const RegionSet *a, const RegionSet *b, u_char op)
+{
+  RegionSet out;
+  u_char prevStart = 0, prevCount = 0;
+  int row, rowNext;
+  out.count = 0;
+  for (row = -NO_EDGE; ; row = rowNext) {
+    Span spans[REGIONSET_MAX];
+    u_char n = 0, i;
+    int col, colNext, edge;
+    rowNext = nextRowEdge(a, row);
+    edge = nextRowEdge(b, row);
+    if (edge < rowNext)
+      rowNext = edge;
+    if (rowNext == NO_EDGE)
+      break;
+    /* columns of band row..rowNext-1 */
+    for (col = -NO_EDGE; col != NO_EDGE; col = colNext) {
+      colNext = nextColEdge(a, row, col);
+      edge = nextColEdge(b, row, col);
+      if (edge < colNext)
+	colNext = edge;
+      if (colNext == NO_EDGE || !setOpKeeps(op, setContains(a, col, row), setContains(b, col, row)))
+	continue;
+      if (n && spans[n-1].end == col - 1) {
+	spans[n-1].end = colNext - 1; /* extends the previous span */
+      } else if (n == REGIONSET_MAX) {
+	return 0;
+      } else {
+	spans[n].start = col;
+	spans[n++].end = colNext - 1;
+      }
+    }
+    if (!n)
+      continue;
+    /* merge with the band above if it is adjacent and has the same columns */
+    if (prevCount == n && out.rects[prevStart].botRight.axes[1] == row - 1) {
+      for (i = 0; i < n; i++)
+	if (out.rects[prevStart + i].topLeft.axes[0] != spans[i].start ||
+	    out.rects[prevStart + i].botRight.axes[0] != spans[i].end)
+	  break;
+      if (i == n) {
+	for (i = 0; i < n; i++)
+	  out.rects[prevStart + i].botRight.axes[1] = rowNext - 1;
+	continue;
+      }
+    }
+    if (out.count + n > REGIONSET_MAX)
+      return 0;
+    prevStart = out.count;
+    prevCount = n;
+    for (i = 0; i < n; i++) {
+      Region *r = &out.rects[out.count++];
+      r->topLeft.axes[0] = spans[i].start;
+      r->botRight.axes[0] = spans[i].end;
+      r->topLeft.axes[1] = row;
+      r->botRight.axes[1] = rowNext - 1;
+    }
+  }
+  *result = out;
+  return 1;
+}
+
+void
+regionSetInit(RegionSet *set, const Region *r)
+{
+  set->count = 0;
+  if (r && !regionIsEmpty(r))
+    set->rects[set->count++] = *r;
+}
+
+int
+regionSetUnion(RegionSet *result, const RegionSet *a, const RegionSet *b)
+{
+  return regionSetOp(result, a, b, SET_UNION);
+}
+
+int
+regionSetIntersect(RegionSet *result, const RegionSet *a, const RegionSet *b)
+{
+  return regionSetOp(result, a, b, SET_INTERSECT);
+}
+
+int
+regionSetSubtract(RegionSet *result, const RegionSet *a, const RegionSet *b)
+{
+  return regionSetOp(result, a, b, SET_SUBTRACT);
+}
+
+long
+regionSetArea(const RegionSet *set)
+{
+  long area = 0;
+  u_char i;
+  for (i = 0; i < set->count; i++)
+    area += regionArea(&set->rects[i]);
+  return area;
+}
@@ -1,4 +1,5 @@
 #include "shape.h"
+#include "_shapekind.h"
 
 const Vec2 screenSize = {screenWidth, screenHeight};
 const Vec2 screenCenter= {screenWidth/2, screenHeight/2};
@@ -19,6 +20,6 @@ abShapeGetBounds(const AbShape *s, const Vec2 *centerPos, Region *bounds)
 int
 abShapeCheck(const AbShape *s, const Vec2 *centerPos, const Vec2 *pixelLoc)
 {
-  return (*s->check)(s, centerPos, pixelLoc);
+  return shapeKindCheck(s, centerPos, pixelLoc);
 }
 
@@ -62,6 +62,63 @@ void regionUnion(Region *rUnion, const Region *r1, const Region *r2);
  */
 void regionClipScreen(Region *region);
 
+/** True if region contains no pixels (botRight left of or above topLeft)
+ */
+int regionIsEmpty(const Region *region);
+
+/** Number of pixels in region
+ */
+long regionArea(const Region *region);
+
+/** True if two regions share a pixel
+ */
+int regionOverlaps(const Region *r1, const Region *r2);
+
+/** Computes the pixels in both regions.
+ *
+ *  \return True (1) if the intersection is not empty
+ */
+int regionIntersect(Region *rIntersect, const Region *r1, const Region *r2);
+
+/** Computes the pixels of a outside b as up to 4 disjoint regions,
+ *  top to bottom and left to right
+ *
+ *  \param pieces (out) The regions
+ *  \return The number of pieces
+ */
+u_char regionSubtract(Region pieces[4], const Region *a, const Region *b);
+
+/** A set of pixels as disjoint regions in X11's band form
+ *
+ *  Regions sharing rows share their top and bottom (a band); bands
+ *  run top to bottom, regions within a band left to right, and
+ *  adjacent bands with the same columns are merged.  A set holds up
+ *  to REGIONSET_MAX regions (8 bytes each).
+ */
+#define REGIONSET_MAX 8
+
+typedef struct {
+  Region rects[REGIONSET_MAX];
+  u_char count;
+} RegionSet;
+
+/** Make set hold region r (empty if r is 0 or empty)
+ */
+void regionSetInit(RegionSet *set, const Region *r);
+
+/** Set operations.  result may be a or b.
+ *
+ *  \return 0, leaving result unchanged, if the result would need more
+ *  than REGIONSET_MAX regions
+ */
+int regionSetUnion(RegionSet *result, const RegionSet *a, const RegionSet *b);
+int regionSetIntersect(RegionSet *result, const RegionSet *a, const RegionSet *b);
+int regionSetSubtract(RegionSet *result, const RegionSet *a, const RegionSet *b); /* a - b */
+
+/** Number of pixels in set
+ */
+long regionSetArea(const RegionSet *set);
+
 /** This function initializes the screen
  *  vectors that are used by shapes
  *
@@ -69,20 +126,51 @@ void regionClipScreen(Region *region);
  */
 void shapeInit();
 
+/** A run of columns start..end (inclusive) within one row
+ */
+typedef struct {
+  int start, end;		/* screen columns */
+} Span;
+
+#define SHAPE_SPANS_MAX 2	/* most spans getSpans may return per row */
+
+/** AbShape kinds (AbShape.kind)
+ *
+ *  Renderers draw the built-in kinds with inline code rather than
+ *  calls through the function pointers, which are only used for
+ *  ABSHAPE_CUSTOM shapes.  Shapes that reuse a built-in function but
+ *  replace another (e.g. shapedemo3's sliced rectangle) are custom.
+ */
+#define ABSHAPE_CUSTOM 0	/* any AbShape: use its functions */
+#define ABSHAPE_RECT 1		/* AbRect */
+#define ABSHAPE_RECT_OUTLINE 2	/* AbRectOutline */
+#define ABSHAPE_RARROW 3	/* AbRArrow */
+#define ABSHAPE_CIRCLE 4	/* AbCircle (circleLib) */
+
 /** Effectively a base class for Abstract Shapes
  *  
  *  Abstract Shapes have a shape but no position or color.
- *  The first two fields MUST BE pointers to
+ *  The first three fields MUST BE pointers to
  *
  *  getBounds: A function that computes the bounding box for the AbShape
  *  when rendered at coordinate centerPos
  * 
  *  check: A function that determines if the AbShape contains pixelLoc when 
  *  rendered at centerPos
+ *
+ *  getSpans: optional (may be 0).  A function that stores the columns
+ *  of row contained by the AbShape when rendered at centerPos as at
+ *  most SHAPE_SPANS_MAX spans, left to right and not overlapping, and
+ *  returns their number.  They must hold exactly the pixels accepted
+ *  by check.  Without it, layerDraw calls check for each pixel.
+ *
+ *  The fourth field is the shape's kind (ABSHAPE_...).
  */
 typedef struct AbShape_s {		/* base type for all abstrct shapes */
   void (*getBounds)(const struct AbShape_s *shape, const Vec2 *centerPos, Region *bounds);
   int (*check)(const struct AbShape_s *shape, const Vec2 *centerPos, const Vec2 *pixelLoc);
+  int (*getSpans)(const struct AbShape_s *shape, const Vec2 *centerPos, int row, Span spans[]);
+  u_char kind;
 } AbShape;
 
 /** Computes bounding box of abShape in screen coordinates 
@@ -110,6 +198,8 @@ int abShapeCheck(const AbShape *shape, const Vec2 *centerPos, const Vec2 *pixelL
 typedef struct AbRArrow_s {
   void (*getBounds)(const struct AbRArrow_s *shape, const Vec2 *centerPos, Region *bounds);
   int (*check)(const struct AbRArrow_s *shape, const Vec2 *centerPos, const Vec2 *pixelLoc);
+  int (*getSpans)(const struct AbRArrow_s *shape, const Vec2 *centerPos, int row, Span spans[]);
+  u_char kind;			/* ABSHAPE_RARROW */
   int size;
 } AbRArrow;
 
@@ -121,6 +211,10 @@ void abRArrowGetBounds(const AbRArrow *arrow, const Vec2 *centerPos, Region *bou
  */
 int abRArrowCheck(const AbRArrow *arrow, const Vec2 *centerPos, const Vec2 *pixel);
 
+/** As required by AbShape
+ */
+int abRArrowGetSpans(const AbRArrow *arrow, const Vec2 *centerPos, int row, Span spans[]);
+
 /** AbShape rectangle
  *
  *  Vector halfSize must be to first quadrant (both axes non-negative).  
@@ -129,6 +223,8 @@ int abRArrowCheck(const AbRArrow *arrow, const Vec2 *centerPos, const Vec2 *pixe
 typedef struct AbRect_s {
   void (*getBounds)(const struct AbRect_s *rect, const Vec2 *centerPos, Region *bounds);
   int (*check)(const struct AbRect_s *shape, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*getSpans)(const struct AbRect_s *shape, const Vec2 *centerPos, int row, Span spans[]);
+  u_char kind;			/* ABSHAPE_RECT or ABSHAPE_RECT_OUTLINE */
   const Vec2 halfSize;	
 } AbRect;
 
@@ -140,6 +236,10 @@ void abRectGetBounds(const AbRect *rect, const Vec2 *centerPos, Region *bounds);
  */
 int abRectCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel);
 
+/** As required by AbShape
+ */
+int abRectGetSpans(const AbRect *rect, const Vec2 *centerPos, int row, Span spans[]);
+
 typedef AbRect AbRectOutline;	/* same as AbRect */
 
 /** As required by AbShape
@@ -150,6 +250,25 @@ void abRectOutlineGetBounds(const AbRect *rect, const Vec2 *centerPos, Region *b
  */
 int abRectOutlineCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel);
 
+/** As required by AbShape
+ */
+int abRectOutlineGetSpans(const AbRect *rect, const Vec2 *centerPos, int row, Span spans[]);
+
+/** AbShape circle (functions in circleLib's abCircle.h)
+ *  
+ *  chords should be a vector of length radius + 1.  
+ *  Entry at index i is 1/2 chord length at distance i from the circle's center.  
+ *  This vector can be generated using lcdLib's computeChordVec() (lcddraw.h).
+ */ 
+typedef struct AbCircle_s {
+  void (*getBounds)(const struct AbCircle_s *circle, const Vec2 *centerPos, Region *bounds);
+  int (*check)(const struct AbCircle_s *circle, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*getSpans)(const struct AbCircle_s *circle, const Vec2 *centerPos, int row, Span spans[]);
+  u_char kind;			/* ABSHAPE_CIRCLE */
+  const u_char *chords;
+  const u_char radius;
+} AbCircle;
+
 /** Linked list of Layers.  
  * 
  *  Each layer contains
@@ -157,12 +276,15 @@ int abRectOutlineCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pi
  *   - the layer's current position
  *   - the layer's color
  *   - a reference to the next (lower) layer.
+ *   - the color it was last drawn with (set by layerInit and
+ *     dirtyAddLayer)
  */
 typedef struct Layer_s {
   AbShape *abShape;
   Vec2 pos, posLast, posNext; /* initially just set pos */
   u_int color;
   struct Layer_s *next;
+  u_int colorLast;
 } Layer;	
 
 /** Compute layer's bounding box.
@@ -176,9 +298,69 @@ void layerInit(Layer *layers);
 
 /** Render all layers.   
  *  Pixels that are not contained by a layer are set to bgColor.
+ *  Rows are composed from the layers' spans (AbShape getSpans), so
+ *  each run of pixels costs one comparison per span edge; layers
+ *  without getSpans are probed pixel by pixel within their bounds.
+ *  Each layer's bounds are computed once per call, and a row only
+ *  visits the layers whose bounds span it (up to 8 layers meeting
+ *  the area; beyond that every layer is visited on every row).
+ *  Shapes must therefore lie within the bounds getBounds reports.
+ *  Built-in shapes are opaque over a rectangle (a rect's bounds, the
+ *  square inside a circle, an arrow's stem): the parts of lower
+ *  layers it hides are neither composed nor probed.
  */
 void layerDraw(Layer *layers);
 
+/** Render the layers within area (clipped to the screen)
+ *  Pixels that are not contained by a layer are set to bgColor.
+ *  Framebuffer drivers are not flushed (see drv_frameDone).
+ */
+void layerDrawRegion(Layer *layers, const Region *area);
+
+/** Number of pixel probes (shape check calls) made by the layer
+ *  renderer; never reset by the library
+ */
+extern unsigned long layerProbes;
+
+/** The areas to redraw in a frame
+ *
+ *  Areas added with dirtyAdd are merged when drawing their bounding
+ *  box costs fewer bytes sent to the lcd than drawing them apart (a
+ *  window costs about as much as 5 pixels, or nothing if lcdDriver
+ *  has LCD_CAP_CHEAPWIN), and otherwise split so
+ *  that every pixel is drawn once.  At most DIRTY_MAX rects are kept;
+ *  beyond that, the two whose bounding box wastes the fewest pixels
+ *  are merged.
+ */
+#define DIRTY_MAX 6
+
+typedef struct {
+  Region rects[DIRTY_MAX];	/* disjoint, within the screen */
+  u_char count;
+} DirtyRegions;
+
+/** Start a frame with nothing to redraw
+ */
+void dirtyInit(DirtyRegions *dirty);
+
+/** Add an area to redraw (clipped to the screen)
+ */
+void dirtyAdd(DirtyRegions *dirty, const Region *area);
+
+/** Add what changed when a layer moved from posLast to pos
+ *
+ *  Its old and new bounds, or, when an opaque shape (ABSHAPE_RECT)
+ *  kept its color and still overlaps its old bounds, only the strips
+ *  it vacated and newly covered.  Records the layer's color for the
+ *  next frame (colorLast).
+ */
+void dirtyAddLayer(DirtyRegions *dirty, Layer *l);
+
+/** Render layers within each dirty rect, end the frame (drv_frameDone)
+ *  and empty dirty
+ */
+void dirtyDraw(DirtyRegions *dirty, Layer *layers);
+
 /** Background color.
   */
 extern u_int bgColor;		/*  background color */
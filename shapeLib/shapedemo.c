@@ -3,7 +3,7 @@
 #include "lcddraw.h"
 #include "shape.h"
 
-const AbRect rect10 = {abRectGetBounds, abRectCheck, 10,2};;
+const AbRect rect10 = {abRectGetBounds, abRectCheck, abRectGetSpans, ABSHAPE_RECT, 10,2};;
 
 void
 abDrawPos(AbShape *shape, Vec2 *shapeCenter, u_int fg_color, u_int bg_color)
@@ -17,7 +17,7 @@ abSlicedRectCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel)
     return abRectCheck(rect, centerPos, pixel);
 }
 
-AbRect rect10 = {abRectGetBounds, abSlicedRectCheck, 10,10};;
+AbRect rect10 = {abRectGetBounds, abSlicedRectCheck, 0, ABSHAPE_CUSTOM, 10,10};;
 
 
 Region fence = {{10,30}, {SHORT_EDGE_PIXELS-10, LONG_EDGE_PIXELS-10}};
@@ -0,0 +1,24 @@
+/** \file clocksHost.c
+ *  \brief No-op timerLib for host builds (libTimerHost.a)
+ *
+ *  Lets demo programs that call configureClocks() etc. run against
+ *  lcdLib's emulated display (see lcdLib/lcdsim.h).
+ */
+#include "libTimer.h"
+
+static int sr;			/* emulated status register */
+
+void configureClocks() {}
+void enableWDTInterrupts() {}
+void timerAUpmode() {}
+
+unsigned char clockProfile;
+void clockSetProfile(unsigned char profile) { clockProfile = profile; }
+static const unsigned char mhz[] = {2, 8, 16}; /* by profile */
+unsigned char clockSmclkMHz() { return mhz[clockProfile]; }
+int clockWdtTick() { return 1; }
+
+void set_sr(int sr_val) { sr = sr_val; }
+int  get_sr(void) { return sr; }
+void or_sr(int or_val) { sr |= or_val; }
+void and_sr(int and_val) { sr &= and_val; }
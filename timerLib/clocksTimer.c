@@ -1,6 +1,22 @@
 #include <msp430.h>
 #include "libTimer.h"
 
+// SMCLK divider and the Timer A / WDT settings that keep their rates
+static const struct {
+  unsigned char divs;		// SMCLK = DCO >> divs
+  unsigned int timerAId;	// Timer A0 input divider: 2 MHz
+  unsigned int wdtInterval;	// 244 Hz, times wdtSubTicks
+  unsigned char wdtSubTicks;
+  unsigned char mhz;
+} profiles[] = {
+  {DIVS_3, ID_0, WDTIS0, 1, 2},	// 2 MHz / 8192
+  {DIVS_1, ID_2, 0, 1, 8},	// 8 MHz / 32768
+  {DIVS_0, ID_3, 0, 2, 16},	// 16 MHz / 32768, every other interrupt
+};
+
+unsigned char clockProfile;
+static unsigned char wdtEnabled, wdtSubTick;
+
 void configureClocks(){
   WDTCTL = WDTPW + WDTHOLD;//Disable Watchdog Timer
   BCSCTL1 = CALBC1_16MHZ;  // Set DCO to 16 Mhz
@@ -8,6 +24,38 @@ void configureClocks(){
     
   BCSCTL2 &= ~(SELS);     // SMCLK source = DCO
   BCSCTL2 |= DIVS_3;      // SMCLK = DCO / 8
+  clockProfile = CLOCK_SLOW;
+}
+
+void clockSetProfile(unsigned char profile)
+{
+  unsigned int mode = TA0CTL & MC_3;
+  clockProfile = profile;
+  TA0CTL &= ~MC_3;		// stop Timer A while its clock changes
+  BCSCTL2 = (BCSCTL2 & ~DIVS_3) | profiles[profile].divs;
+  if (mode) {			// running: keep counting at 2 MHz
+    TA0CTL = (TA0CTL & ~ID_3) | profiles[profile].timerAId | TACLR; // reset the divider
+    TA0CTL |= mode;
+  }
+  // Clear the WDT count: the count in progress may already be past
+  // the new interval's end, which would interrupt at once.
+  if (wdtEnabled) {
+    WDTCTL = WDTPW | WDTTMSEL | WDTCNTCL | profiles[profile].wdtInterval;
+    wdtSubTick = 0;
+  }
+}
+
+unsigned char clockSmclkMHz()
+{
+  return profiles[clockProfile].mhz;
+}
+
+int clockWdtTick()
+{
+  if (++wdtSubTick < profiles[clockProfile].wdtSubTicks)
+    return 0;
+  wdtSubTick = 0;
+  return 1;
 }
 
 
@@ -18,8 +66,9 @@ void enableWDTInterrupts()
   WDTCTL = WDTPW |	   // passwd req'd.  Otherwise device resets
     WDTTMSEL |		     // watchdog interval mode 
     WDTCNTCL |		     // clear watchdog count
-    1;			     // divide SMCLK by 8192
+    profiles[clockProfile].wdtInterval; // 244 Hz (SMCLK / 8192 at 2 MHz)
   IE1 |= WDTIE;		   // Enable watchdog interval timer interrupt
+  wdtEnabled = 1;
 }
 
 
@@ -32,7 +81,8 @@ void timerAUpmode()
   // Timer A control:
   //  Timer clock source 2: system clock (SMCLK)
   //  Mode Control 1: continuously 0...CCR0
-  TACTL = TASSEL_2 + MC_1;   
+  //  Input divider: 2 MHz in every clock profile
+  TACTL = TASSEL_2 + MC_1 + profiles[clockProfile].timerAId;   
 }
 
 
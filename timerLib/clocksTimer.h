@@ -5,4 +5,43 @@ void configureClocks();
 void enableWDTInterrupts();
 void timerAUpmode();
 
+/** Clock profiles
+ *
+ *  The CPU always runs at 16 MHz; a profile sets SMCLK, which clocks
+ *  the LCD's SPI bus.  Timer A0 (and so buzzer periods) keeps
+ *  counting at 2 MHz and the WDT interval stays at 244 Hz in every
+ *  profile.  Timer1_A keeps its SMCLK/8 divider, so it counts faster
+ *  in the faster profiles (see clockSmclkMHz).
+ *
+ *  CLOCK_MAX clocks the bus at 16 MHz, above the ST7735's 15 MHz
+ *  write clock limit; CLOCK_FAST (8 MHz) is within spec.
+ */
+#define CLOCK_SLOW 0		/**< SMCLK = DCO/8 = 2 MHz (configureClocks) */
+#define CLOCK_FAST 1		/**< SMCLK = DCO/2 = 8 MHz */
+#define CLOCK_MAX  2		/**< SMCLK = DCO = 16 MHz */
+
+/** Switch SMCLK to a profile and retime Timer A0 and the WDT
+ *
+ *  The WDT count is cleared, since the count in progress may already
+ *  be past the new interval's end: the tick in progress comes up to
+ *  one interval (4.1 ms) late, so switch around whole frames rather
+ *  than inside pixel loops.
+ *  A running Timer A0 is stopped while its divider changes and then
+ *  restarts from 0 (TACLR), so the buzzer's current period restarts.
+ */
+void clockSetProfile(unsigned char profile);
+
+/** Current profile */
+extern unsigned char clockProfile;
+
+/** SMCLK frequency in MHz (2, 8 or 16) */
+unsigned char clockSmclkMHz();
+
+/** Call first in the WDT interrupt handler and return if it is 0
+ *
+ *  CLOCK_MAX cannot divide 16 MHz down to 244 Hz, so there the WDT
+ *  interrupts at 488 Hz and every other interrupt is skipped.
+ */
+int clockWdtTick();
+
 #endif